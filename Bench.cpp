@@ -0,0 +1,164 @@
+/**
+ * @file Bench.cpp
+ * @brief Benchmarks of MagicalContainer, printed as JSON.
+ * @details For every size from 10^2 up to the given maximum (10^7 by default) it measures
+ * addElement and removeElement on a container of that size, building the views of a
+ * container of that size in bulk, a full pass of every iterator, a batched ascending pass
+ * with fetchBatch, and the replay of a mixed add/remove/iterate workload. Values follow
+ * the given distribution (see Workload.hpp).
+ *
+ * usage: ./bench [max_size] [seed] [distribution]
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "Workload.hpp"
+#include "sources/MagicalContainer.hpp"
+
+using namespace ariel;
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    bool firstResult = true;
+
+    void report(size_t size, const std::string &operation, size_t iterations, double seconds, std::int64_t checksum)
+    {
+        std::cout << (firstResult ? "\n" : ",\n")
+                  << "    {\"size\": " << size
+                  << ", \"operation\": \"" << operation << "\""
+                  << ", \"iterations\": " << iterations
+                  << ", \"ns_per_op\": " << seconds * 1e9 / static_cast<double>(iterations)
+                  << ", \"checksum\": " << checksum << "}";
+        firstResult = false;
+    }
+
+    double since(Clock::time_point start)
+    {
+        return std::chrono::duration<double>(Clock::now() - start).count();
+    }
+
+    // Time one full pass of an iterator, the sum keeps the loop from being optimised away
+    template <typename Iterator>
+    void benchIteration(MagicalContainer &container, const std::string &operation)
+    {
+        Iterator iterator(container);
+        std::int64_t sum = 0;
+        size_t steps = 0;
+        auto start = Clock::now();
+        for (auto it = iterator.begin(); it != iterator.end(); ++it)
+        {
+            sum += *it;
+            ++steps;
+        }
+        double seconds = since(start);
+        report(container.size(), operation, steps == 0 ? 1 : steps, seconds, sum);
+    }
+
+    // Time one full pass of an iterator in batches of 1024 values
+    template <typename Iterator>
+    void benchBatches(MagicalContainer &container, const std::string &operation)
+    {
+        Iterator iterator(container);
+        std::vector<int> batch(1024);
+        std::int64_t sum = 0;
+        size_t steps = 0;
+        auto start = Clock::now();
+        for (size_t fetched; (fetched = iterator.fetchBatch(batch)) != 0;)
+        {
+            for (size_t i = 0; i < fetched; ++i)
+                sum += batch[i];
+            steps += fetched;
+        }
+        double seconds = since(start);
+        report(container.size(), operation, steps == 0 ? 1 : steps, seconds, sum);
+    }
+
+    // Replay a mixed workload on a container, an iteration is one full ascending pass
+    std::int64_t replay(MagicalContainer &container, const std::vector<workload::Operation> &operations)
+    {
+        std::int64_t sum = 0;
+        for (const auto &operation : operations)
+        {
+            switch (operation.kind)
+            {
+            case workload::Operation::Kind::Add:
+                container.addElement(operation.value);
+                break;
+            case workload::Operation::Kind::Remove:
+                container.removeElement(operation.value);
+                break;
+            case workload::Operation::Kind::Iterate:
+                MagicalContainer::AscendingIterator iterator(container);
+                for (auto it = iterator.begin(); it != iterator.end(); ++it)
+                    sum += *it;
+                break;
+            }
+        }
+        return sum;
+    }
+
+    void benchSize(size_t size, workload::Config config)
+    {
+        config.seed += size;
+        std::vector<int> elements = workload::values(config, size);
+
+        // building all views once, from scratch
+        MagicalContainer container;
+        auto start = Clock::now();
+        container.addElements(elements);
+        report(size, "buildViews", 1, since(start), static_cast<std::int64_t>(container.size()));
+
+        // single mutations cost O(size), so fewer of them are timed on large containers
+        size_t mutations = std::max<size_t>(1, std::min<size_t>(1000, 100000000 / size));
+
+        config.seed += 1;
+        std::vector<int> added = workload::values(config, mutations);
+        start = Clock::now();
+        for (int element : added)
+            container.addElement(element);
+        report(size, "addElement", mutations, since(start), static_cast<std::int64_t>(container.size()));
+
+        start = Clock::now();
+        for (int element : added)
+            container.removeElement(element);
+        report(size, "removeElement", mutations, since(start), static_cast<std::int64_t>(container.size()));
+
+        benchIteration<MagicalContainer::AscendingIterator>(container, "iterateAscending");
+        benchIteration<MagicalContainer::SideCrossIterator>(container, "iterateSideCross");
+        benchIteration<MagicalContainer::PrimeIterator>(container, "iteratePrime");
+        benchBatches<MagicalContainer::AscendingIterator>(container, "batchAscending");
+
+        config.seed += 1;
+        std::vector<workload::Operation> operations = workload::operations(config, workload::Mix{}, mutations);
+        start = Clock::now();
+        std::int64_t sum = replay(container, operations);
+        report(size, "mixedWorkload", mutations, since(start), sum);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    size_t maxSize = argc > 1 ? std::stoull(argv[1]) : 10000000;
+    workload::Config config;
+    config.minValue = -1000000000;
+    config.maxValue = 1000000000;
+    config.seed = argc > 2 ? std::stoull(argv[2]) : config.seed;
+    config.distribution = argc > 3 ? workload::parseDistribution(argv[3]) : workload::Distribution::Uniform;
+
+    std::cout << "{\n  \"benchmark\": \"MagicalContainer\",\n  \"seed\": " << config.seed
+              << ",\n  \"distribution\": \"" << workload::name(config.distribution) << "\",\n  \"results\": [";
+    for (size_t size = 100; size <= maxSize; size *= 10)
+    {
+        benchSize(size, config);
+    }
+    std::cout << "\n  ]\n}" << std::endl;
+    return 0;
+}
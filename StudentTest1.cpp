@@ -1,6 +1,25 @@
 #include "doctest.h"
 #include "sources/MagicalContainer.hpp"
+#include "sources/RunLengthContainer.hpp"
+#include "sources/FrozenContainer.hpp"
+#include "sources/Parallel.hpp"
+#include "sources/BackgroundContainer.hpp"
+#include "sources/RangeShardedContainer.hpp"
+#include "sources/HashShardedContainer.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <memory_resource>
+#include <ranges>
+#include <sstream>
 #include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
 
 using namespace ariel;
 using namespace std;
@@ -597,3 +616,1412 @@ TEST_CASE("operator= throws when iterators are pointing at different containers"
 }
 
 
+
+TEST_CASE("MagicalContainer with a memory resource") {
+    std::pmr::monotonic_buffer_resource arena;
+    MagicalContainer container(&arena);
+    container.reserve(5);
+    container.addElement(14);
+    container.addElement(5);
+    container.addElement(2);
+
+    CHECK(container.get_allocator().resource() == &arena);
+
+    SUBCASE("Iterating over elements") {
+        MagicalContainer::AscendingIterator it(container);
+        CHECK(*it == 2);
+        ++it;
+        CHECK(*it == 5);
+        ++it;
+        CHECK(*it == 14);
+    }
+
+    SUBCASE("Copying into another resource") {
+        std::pmr::unsynchronized_pool_resource pool;
+        MagicalContainer copy(container, &pool);
+        container.removeElement(5);
+        CHECK(copy.get_allocator().resource() == &pool);
+        CHECK(copy.size() == 3);
+        MagicalContainer::PrimeIterator it(copy);
+        CHECK(*it == 5);
+        ++it;
+        CHECK(*it == 2);
+    }
+
+    SUBCASE("Moving across resources") {
+        MagicalContainer other;
+        other = std::move(container);
+        CHECK(other.get_allocator().resource() == std::pmr::get_default_resource());
+        CHECK(container.size() == 0);
+        MagicalContainer::SideCrossIterator it(other);
+        CHECK(*it == 2);
+        ++it;
+        CHECK(*it == 14);
+        ++it;
+        CHECK(*it == 5);
+    }
+
+    SUBCASE("A failed move across resources leaves both containers unchanged") {
+        std::pmr::monotonic_buffer_resource bounded(std::pmr::null_memory_resource());
+        MagicalContainer other(&bounded);
+        CHECK_THROWS_AS(other = std::move(container), std::bad_alloc);
+        CHECK(other.size() == 0);
+        CHECK(container.size() == 3);
+    }
+}
+
+TEST_CASE("MagicalContainer over other integer widths") {
+    SUBCASE("uint32_t values above INT_MAX") {
+        BasicMagicalContainer<std::uint32_t> container;
+        container.addElement(4294967291U); // largest 32-bit prime
+        container.addElement(3U);
+        container.addElement(2147483648U);
+
+        BasicMagicalContainer<std::uint32_t>::AscendingIterator it(container);
+        CHECK(*it == 3U);
+        ++it;
+        CHECK(*it == 2147483648U);
+        ++it;
+        CHECK(*it == 4294967291U);
+
+        BasicMagicalContainer<std::uint32_t>::PrimeIterator primes(container);
+        CHECK(*primes == 4294967291U);
+        ++primes;
+        CHECK(*primes == 3U);
+        ++primes;
+        CHECK(primes == primes.end());
+    }
+
+    SUBCASE("int64_t with negative values") {
+        BasicMagicalContainer<std::int64_t> container;
+        container.addElement(-5000000000LL);
+        container.addElement(7);
+        container.addElement(-7);
+        container.addElement(5000000000LL);
+
+        BasicMagicalContainer<std::int64_t>::SideCrossIterator it(container);
+        CHECK(*it == -5000000000LL);
+        ++it;
+        CHECK(*it == 5000000000LL);
+        ++it;
+        CHECK(*it == -7);
+        ++it;
+        CHECK(*it == 7);
+
+        BasicMagicalContainer<std::int64_t>::PrimeIterator primes(container);
+        CHECK(*primes == 7);
+        ++primes;
+        CHECK(primes == primes.end());
+    }
+
+    SUBCASE("uint64_t primality beyond 32 bits") {
+        BasicMagicalContainer<std::uint64_t> container;
+        container.addElement(18446744073709551557ULL); // largest 64-bit prime
+        container.addElement(3215031751ULL);           // strong pseudoprime to bases 2, 3, 5, 7
+        container.addElement(1000000007ULL * 998244353ULL);
+        container.addElement(1000000007ULL);
+
+        BasicMagicalContainer<std::uint64_t>::PrimeIterator primes(container);
+        CHECK(*primes == 18446744073709551557ULL);
+        ++primes;
+        CHECK(*primes == 1000000007ULL);
+        ++primes;
+        CHECK(primes == primes.end());
+    }
+
+    SUBCASE("Large containers are ordered by the radix kernel") {
+        BasicMagicalContainer<std::int64_t> container;
+        for (std::int64_t i = 0; i < 200; ++i) {
+            container.addElement((i * 7919) % 200 - 100);
+        }
+        BasicMagicalContainer<std::int64_t>::AscendingIterator it(container);
+        for (std::int64_t expected = -100; expected < 100; ++expected) {
+            CHECK(*it == expected);
+            ++it;
+        }
+        CHECK(it == it.end());
+    }
+
+    SUBCASE("The view index width bounds the number of elements") {
+        static_assert(sizeof(MagicalContainer::index_type) == 4);
+        static_assert(sizeof(WideMagicalContainer<std::int64_t>::index_type) == 8);
+
+        CompactMagicalContainer<int> compact;
+        std::vector<int> values(65535);
+        for (size_t i = 0; i < values.size(); ++i)
+            values[i] = static_cast<int>(values.size() - i);
+        compact.addElements(values);
+        CHECK(compact.size() == 65535);
+        CHECK_THROWS_AS(compact.addElement(0), std::length_error);
+        std::vector<int> more{0, -1};
+        CHECK_THROWS_AS(compact.addElements(more), std::length_error);
+        CHECK(compact.size() == 65535);
+        CompactMagicalContainer<int>::AscendingIterator ascending(compact);
+        CHECK(*ascending == 1);
+
+        // room again after a removal
+        compact.removeElement(1);
+        CHECK_NOTHROW(compact.addElement(-1));
+        CompactMagicalContainer<int>::AscendingIterator again(compact);
+        CHECK(*again == -1);
+
+        WideMagicalContainer<std::uint64_t> wide;
+        wide.addElement(18446744073709551557ULL);
+        wide.addElement(4);
+        WideMagicalContainer<std::uint64_t>::PrimeIterator primes(wide);
+        CHECK(*primes == 18446744073709551557ULL);
+        WideMagicalContainer<std::uint64_t>::SideCrossIterator cross(wide);
+        CHECK(*cross == 4);
+    }
+}
+
+// a user-defined order: by distance from zero, ties in insertion order
+struct ByMagnitude {
+    bool operator()(int a, int b) const { return std::abs(a) < std::abs(b); }
+};
+
+TEST_CASE("User-defined views") {
+    MagicalContainer container;
+    container.addElement(7);
+    container.addElement(-2);
+    container.addElement(10);
+    container.addElement(3);
+
+    SUBCASE("Filter views are kept up to date") {
+        MagicalContainer::FilterIterator<IsEven> it(container);
+        container.addElement(4);
+        CHECK(*it == -2);
+        ++it;
+        CHECK(*it == 10);
+        ++it;
+        CHECK(*it == 4);
+        ++it;
+        CHECK(it == it.end());
+
+        container.removeElement(10);
+        MagicalContainer::FilterIterator<IsEven> again(container);
+        CHECK(*again == -2);
+        ++again;
+        CHECK(*again == 4);
+        ++again;
+        CHECK(again == again.end());
+    }
+
+    SUBCASE("Band filter") {
+        MagicalContainer::FilterIterator<InBand<0, 7>> it(container);
+        CHECK(*it == 7);
+        ++it;
+        CHECK(*it == 3);
+        ++it;
+        CHECK(it == it.end());
+    }
+
+    SUBCASE("Descending order") {
+        container.addElement(7);
+        container.removeElement(-2);
+        MagicalContainer::OrderIterator<std::greater<int>> it(container);
+        CHECK(*it == 10);
+        ++it;
+        CHECK(*it == 7);
+        ++it;
+        CHECK(*it == 7);
+        ++it;
+        CHECK(*it == 3);
+        ++it;
+        CHECK(it == it.end());
+    }
+
+    SUBCASE("Custom comparator") {
+        const auto &view = container.view<MagicalContainer::Order<ByMagnitude>>();
+        container.addElement(-1);
+        CHECK(view.size() == 5);
+        MagicalContainer::OrderIterator<ByMagnitude> it(container);
+        CHECK(*it == -1);
+        ++it;
+        CHECK(*it == -2);
+        ++it;
+        CHECK(*it == 3);
+        ++it;
+        CHECK(*it == 7);
+    }
+
+    SUBCASE("Copies keep their own views") {
+        MagicalContainer::FilterIterator<IsOdd> odd(container);
+        MagicalContainer copy(container);
+        container.removeElement(7);
+        MagicalContainer::FilterIterator<IsOdd> copied(copy);
+        CHECK(*copied == 7);
+        ++copied;
+        CHECK(*copied == 3);
+        CHECK(*odd == 3);
+    }
+}
+
+TEST_CASE("Copy-on-write copies") {
+    MagicalContainer container;
+    container.addElement(5);
+    container.addElement(1);
+    container.addElement(3);
+
+    SUBCASE("Copies are independent after modification") {
+        MagicalContainer copy(container);
+        CHECK(copy == container);
+        copy.addElement(2);
+        container.removeElement(5);
+
+        MagicalContainer::AscendingIterator original(container);
+        CHECK(*original == 1);
+        ++original;
+        CHECK(*original == 3);
+        ++original;
+        CHECK(original == original.end());
+
+        MagicalContainer::AscendingIterator copied(copy);
+        CHECK(*copied == 1);
+        ++copied;
+        CHECK(*copied == 2);
+        ++copied;
+        CHECK(*copied == 3);
+        ++copied;
+        CHECK(*copied == 5);
+    }
+
+    SUBCASE("Iterators follow their own container") {
+        MagicalContainer::PrimeIterator it(container);
+        MagicalContainer snapshot;
+        snapshot = container;
+        container.addElement(7);
+        CHECK(snapshot.size() == 3);
+        ++(++it);
+        CHECK(*it == 7);
+        MagicalContainer::PrimeIterator snap(snapshot);
+        CHECK(*snap == 5);
+        ++(++snap);
+        CHECK(snap == snap.end());
+    }
+
+    SUBCASE("Moved-from containers stay usable") {
+        MagicalContainer moved(std::move(container));
+        CHECK(moved.size() == 3);
+        CHECK(container.size() == 0);
+        container.addElement(11);
+        CHECK(container.size() == 1);
+        CHECK(moved.size() == 3);
+    }
+}
+
+TEST_CASE("Saving and opening snapshots") {
+    const std::string path = "magical_snapshot_test.bin";
+    MagicalContainer container;
+    container.addElement(9);
+    container.addElement(2);
+    container.addElement(17);
+    container.addElement(4);
+    container.save(path);
+
+    SUBCASE("The views are loaded prebuilt") {
+        MagicalContainer loaded = MagicalContainer::open(path);
+        CHECK(loaded == container);
+
+        MagicalContainer::AscendingIterator ascending(loaded);
+        CHECK(*ascending == 2);
+        ++ascending;
+        CHECK(*ascending == 4);
+
+        MagicalContainer::SideCrossIterator cross(loaded);
+        ++cross;
+        CHECK(*cross == 17);
+
+        MagicalContainer::PrimeIterator primes(loaded);
+        CHECK(*primes == 2);
+        ++primes;
+        CHECK(*primes == 17);
+        ++primes;
+        CHECK(primes == primes.end());
+    }
+
+    SUBCASE("Loaded containers can be modified") {
+        MagicalContainer loaded = MagicalContainer::open(path);
+        loaded.removeElement(2);
+        loaded.addElement(3);
+        MagicalContainer::AscendingIterator it(loaded);
+        CHECK(*it == 3);
+        ++it;
+        CHECK(*it == 4);
+
+        MagicalContainer reopened = MagicalContainer::open(path);
+        CHECK(reopened == container);
+    }
+
+    SUBCASE("Snapshots of another element type are rejected") {
+        CHECK_THROWS_AS(BasicMagicalContainer<std::uint64_t>::open(path), std::runtime_error);
+        CHECK_THROWS_AS(MagicalContainer::open("no_such_snapshot.bin"), std::runtime_error);
+    }
+
+    std::remove(path.c_str());
+}
+
+TEST_CASE("Ingesting integers from text") {
+    MagicalContainer container;
+    container.addElement(100);
+
+    SUBCASE("Newline and comma separated values") {
+        std::istringstream input("5,3\n-7, 11\r\n2\n\n");
+        CHECK(container.ingest(input) == 5);
+        CHECK(container.size() == 6);
+
+        MagicalContainer::AscendingIterator it(container);
+        CHECK(*it == -7);
+        ++it;
+        CHECK(*it == 2);
+
+        MagicalContainer::PrimeIterator primes(container);
+        CHECK(*primes == 5);
+        ++primes;
+        CHECK(*primes == 3);
+        ++primes;
+        CHECK(*primes == 11);
+    }
+
+    SUBCASE("Values spanning several read chunks") {
+        std::string text;
+        for (int i = 0; i < 300000; ++i) {
+            text += std::to_string(1000000 + i);
+            text += (i % 2 == 0) ? ',' : '\n';
+        }
+        std::istringstream input(text);
+        CHECK(container.ingest(input) == 300000);
+        MagicalContainer::AscendingIterator it(container);
+        CHECK(*it == 100);
+        ++it;
+        CHECK(*it == 1000000);
+    }
+
+    SUBCASE("A negative value across the chunk boundary") {
+        // the sign is the last byte of the first 1 MiB chunk
+        std::string text = "7" + std::string((size_t(1) << 20) - 2, ' ') + "-123,5";
+        std::istringstream input(text);
+        CHECK(container.ingest(input) == 3);
+        MagicalContainer::AscendingIterator it(container);
+        CHECK(*it == -123);
+        ++it;
+        CHECK(*it == 5);
+    }
+
+    SUBCASE("Malformed input leaves the container unchanged") {
+        std::istringstream input("1,2,x3,4");
+        CHECK_THROWS_AS(container.ingest(input), std::runtime_error);
+        std::istringstream overflow("99999999999");
+        CHECK_THROWS_AS(container.ingest(overflow), std::runtime_error);
+        CHECK(container.size() == 1);
+    }
+
+    SUBCASE("Ingesting a file") {
+        const std::string path = "magical_ingest_test.txt";
+        {
+            std::ofstream out(path);
+            out << "4,8\n15\n16,23,42";
+        }
+        CHECK(container.ingest(path) == 6);
+        MagicalContainer::SideCrossIterator it(container);
+        CHECK(*it == 4);
+        ++it;
+        CHECK(*it == 100);
+        std::remove(path.c_str());
+    }
+
+    SUBCASE("Adding elements in bulk") {
+        std::vector<int> values = {9, 1, 7};
+        container.addElements(values);
+        MagicalContainer::AscendingIterator it(container);
+        CHECK(*it == 1);
+        ++it;
+        CHECK(*it == 7);
+        MagicalContainer::PrimeIterator primes(container);
+        CHECK(*primes == 7);
+    }
+}
+
+TEST_CASE("Instrumentation counters") {
+    MagicalContainer container;
+    container.addElement(3);
+    container.addElement(4);
+    std::vector<int> values = {5, 6, 7};
+    container.addElements(values);
+    container.removeElement(4);
+
+    const MagicalContainer::Stats &stats = container.stats();
+    if (MagicalContainer::statsEnabled()) {
+        CHECK(stats.sortRebuilds == 1);
+        CHECK(stats.primeRebuilds == 1);
+        CHECK(stats.crossRebuilds == 4);
+        CHECK(stats.primeChecks == 2 + 5);
+        CHECK(stats.largestRebuild == 5);
+        CHECK(stats.incrementalUpdates == 6);
+    } else {
+        CHECK(stats.sortRebuilds == 0);
+        CHECK(stats.crossRebuilds == 0);
+        CHECK(stats.primeChecks == 0);
+    }
+
+    container.resetStats();
+    CHECK(container.stats().crossRebuilds == 0);
+    MagicalContainer copy(container);
+    CHECK(copy.stats().sortNanoseconds == 0);
+
+    // compiled out, the counters take no room in the container
+    if (!MagicalContainer::statsEnabled())
+        CHECK(sizeof(MagicalContainer) == sizeof(std::pmr::memory_resource *) + sizeof(std::shared_ptr<int>));
+}
+
+TEST_CASE("Memory usage per view") {
+    MagicalContainer container;
+    CHECK(container.memoryUsage().used() == 0);
+
+    std::vector<int> values = {2, 4, 5, 8, 11};
+    container.addElements(values);
+    MagicalContainer::MemoryUsage usage = container.memoryUsage();
+    CHECK(usage.regular.used == 5 * sizeof(int));
+    CHECK(usage.sort.used == 5 * sizeof(MagicalContainer::index_type));
+    CHECK(usage.cross.used == 5 * sizeof(MagicalContainer::index_type));
+    CHECK(usage.prime.used == 3 * sizeof(MagicalContainer::index_type));
+    CHECK(usage.views.used == 0);
+    CHECK(usage.regular.capacity >= usage.regular.used);
+    CHECK(usage.capacity() >= usage.used());
+    CHECK_FALSE(usage.shared);
+
+    container.view<MagicalContainer::Filter<IsEven>>();
+    CHECK(container.memoryUsage().views.used == 3 * sizeof(MagicalContainer::index_type));
+
+    MagicalContainer copy(container);
+    CHECK(container.memoryUsage().shared);
+    copy.addElement(3);
+    CHECK_FALSE(container.memoryUsage().shared);
+}
+
+TEST_CASE("Range queries on the ascending view") {
+    MagicalContainer container;
+    std::vector<int> values = {9, 3, 7, 3, 12, 5, 7, 1};
+    container.addElements(values);
+    MagicalContainer::AscendingIterator ascending(container);
+
+    SUBCASE("Lower and upper bounds") {
+        CHECK(*ascending.lowerBound(4) == 5);
+        CHECK(*ascending.lowerBound(7) == 7);
+        CHECK(*ascending.upperBound(7) == 9);
+        CHECK(ascending.lowerBound(0) == ascending.begin());
+        CHECK(ascending.lowerBound(13) == ascending.end());
+        CHECK(ascending.upperBound(12) == ascending.end());
+        CHECK_THROWS_AS(*ascending.upperBound(12), std::runtime_error);
+    }
+
+    SUBCASE("Equal range") {
+        auto [first, last] = ascending.equalRange(3);
+        CHECK(last.position() - first.position() == 2);
+        CHECK(*first == 3);
+        ++first;
+        CHECK(*first == 3);
+        ++first;
+        CHECK(first == last);
+        auto missing = ascending.equalRange(4);
+        CHECK(missing.first == missing.second);
+    }
+
+    SUBCASE("Iterating a half-open range") {
+        std::vector<int> seen;
+        for (int value : container.range(3, 9))
+            seen.push_back(value);
+        CHECK(seen == std::vector<int>{3, 3, 5, 7, 7});
+        CHECK(container.range(3, 9).size() == 5);
+        CHECK(container.range(10, 12).size() == 0);
+        CHECK(container.range(9, 3).empty());
+        CHECK(container.range(-5, 100).size() == container.size());
+    }
+}
+
+TEST_CASE("Order statistics") {
+    MagicalContainer container;
+    CHECK_THROWS_AS(container.median(), std::runtime_error);
+    CHECK_THROWS_AS(container.percentile(50), std::runtime_error);
+
+    for (int value = 100; value >= 1; --value)
+        container.addElement(value);
+    CHECK(container.kthSmallest(0) == 1);
+    CHECK(container.kthSmallest(99) == 100);
+    CHECK_THROWS_AS(container.kthSmallest(100), std::runtime_error);
+    CHECK(container.median() == 50);
+    CHECK(container.percentile(0) == 1);
+    CHECK(container.percentile(50) == 50);
+    CHECK(container.percentile(95) == 95);
+    CHECK(container.percentile(99.5) == 100);
+    CHECK(container.percentile(100) == 100);
+    CHECK_THROWS_AS(container.percentile(101), std::runtime_error);
+
+    // whole ranks are not pushed up by rounding, 0.07 * 100 is 7.000000000000001
+    CHECK(container.percentile(7) == 7);
+    for (int p = 1; p <= 100; ++p)
+        CHECK(container.percentile(p) == p);
+    CHECK(container.percentile(6.5) == 7);
+
+    container.removeElement(1);
+    CHECK(container.kthSmallest(0) == 2);
+    CHECK(container.median() == 51);
+}
+
+TEST_CASE("Range counts and sums") {
+    MagicalContainer container;
+    CHECK(container.countInRange(0, 100) == 0);
+    CHECK(container.memoryUsage().views.used == 0);
+
+    std::vector<int> values = {5, -3, 12, 5, 8, 40, -3};
+    container.addElements(values);
+    CHECK(container.countInRange(-3, 8) == 5);
+    CHECK(container.sumInRange(-3, 8) == 12);
+    CHECK(container.countInRange(6, 7) == 0);
+    CHECK(container.countInRange(9, 1) == 0);
+    CHECK(container.sumInRange(-100, 100) == 64);
+
+    SUBCASE("Kept up to date by add and remove") {
+        container.addElement(7);
+        container.addElement(5);
+        CHECK(container.countInRange(5, 7) == 4);
+        CHECK(container.sumInRange(5, 7) == 22);
+        container.removeElement(5);
+        container.removeElement(40);
+        CHECK(container.countInRange(5, 7) == 3);
+        CHECK(container.sumInRange(0, 1000) == 37);
+    }
+
+    SUBCASE("Matches a scan after many mutations") {
+        std::vector<int> live(values);
+        unsigned state = 7;
+        for (int step = 0; step < 300; ++step) {
+            state = state * 1103515245U + 12345U;
+            int value = static_cast<int>(state >> 16U) % 50 - 10;
+            if (step % 3 == 2 && !live.empty()) {
+                value = live[static_cast<size_t>(step) % live.size()];
+                container.removeElement(value);
+                live.erase(std::find(live.begin(), live.end(), value));
+            } else {
+                container.addElement(value);
+                live.push_back(value);
+            }
+            size_t count = 0;
+            long long sum = 0;
+            for (int element : live) {
+                if (element >= 0 && element <= 20) {
+                    ++count;
+                    sum += element;
+                }
+            }
+            CHECK(container.countInRange(0, 20) == count);
+            CHECK(container.sumInRange(0, 20) == sum);
+        }
+    }
+
+    SUBCASE("Values that disappear are compacted away") {
+        for (int value = 100; value < 120; ++value)
+            container.addElement(value);
+        size_t grown = container.memoryUsage().views.used;
+        for (int value = 100; value < 118; ++value)
+            container.removeElement(value);
+        CHECK(container.memoryUsage().views.used < grown);
+        CHECK(container.countInRange(100, 200) == 2);
+        CHECK(container.sumInRange(100, 200) == 237);
+        container.addElement(105);
+        CHECK(container.countInRange(100, 110) == 1);
+    }
+
+    SUBCASE("Sums of 64-bit elements wrap modulo 2^64") {
+        constexpr std::int64_t largest = std::numeric_limits<std::int64_t>::max();
+        BasicMagicalContainer<std::int64_t> wide;
+        std::vector<std::int64_t> large = {largest, largest - 1, 5};
+        wide.addElements(large);
+        CHECK(wide.sumInRange(0, largest) == 2);
+        CHECK(wide.sumInRange(6, largest) == -3);
+        wide.removeElement(largest - 1);
+        CHECK(wide.sumInRange(0, largest) == std::numeric_limits<std::int64_t>::min() + 4);
+    }
+
+    SUBCASE("Copies keep their own index") {
+        MagicalContainer copy(container);
+        copy.addElement(6);
+        CHECK(copy.countInRange(6, 6) == 1);
+        CHECK(container.countInRange(6, 6) == 0);
+    }
+}
+
+TEST_CASE("Merging containers") {
+    MagicalContainer first;
+    MagicalContainer second;
+    std::vector<int> firstValues = {8, 3, 5, 3};
+    std::vector<int> secondValues = {4, 3, 11, 1};
+    first.addElements(firstValues);
+    second.addElements(secondValues);
+
+    auto ascending = [](MagicalContainer &container) {
+        std::vector<int> seen;
+        MagicalContainer::AscendingIterator it(container);
+        for (auto at = it.begin(); at != it.end(); ++at)
+            seen.push_back(*at);
+        return seen;
+    };
+    auto primes = [](MagicalContainer &container) {
+        std::vector<int> seen;
+        MagicalContainer::PrimeIterator it(container);
+        for (auto at = it.begin(); at != it.end(); ++at)
+            seen.push_back(*at);
+        return seen;
+    };
+
+    SUBCASE("Merged copy") {
+        MagicalContainer result = MagicalContainer::merged(first, second);
+        CHECK(result.size() == 8);
+        CHECK(ascending(result) == std::vector<int>{1, 3, 3, 3, 4, 5, 8, 11});
+        CHECK(primes(result) == std::vector<int>{3, 5, 3, 3, 11});
+        MagicalContainer::SideCrossIterator cross(result);
+        CHECK(*cross == 1);
+        ++cross;
+        CHECK(*cross == 11);
+        CHECK(first.size() == 4);
+        CHECK(second.size() == 4);
+
+        // the merged order matches a container built from scratch
+        MagicalContainer rebuilt;
+        rebuilt.addElements(firstValues);
+        rebuilt.addElements(secondValues);
+        CHECK(result == rebuilt);
+        result.removeElement(3);
+        CHECK(ascending(result) == std::vector<int>{1, 3, 3, 4, 5, 8, 11});
+    }
+
+    SUBCASE("Merging into a container") {
+        first.view<MagicalContainer::Filter<IsEven>>();
+        first.merge(std::move(second));
+        CHECK(first.size() == 8);
+        CHECK(second.size() == 0);
+        CHECK(ascending(first) == std::vector<int>{1, 3, 3, 3, 4, 5, 8, 11});
+        CHECK(first.view<MagicalContainer::Filter<IsEven>>().size() == 2);
+        CHECK_THROWS_AS(first.merge(std::move(first)), std::invalid_argument);
+
+        MagicalContainer empty;
+        empty.merge(std::move(first));
+        CHECK(empty.size() == 8);
+        CHECK(primes(empty) == std::vector<int>{3, 5, 3, 3, 11});
+    }
+
+    SUBCASE("Merging a container with itself") {
+        MagicalContainer result = MagicalContainer::merged(first, first);
+        CHECK(ascending(result) == std::vector<int>{3, 3, 3, 3, 5, 5, 8, 8});
+        CHECK(first.size() == 4);
+    }
+}
+
+TEST_CASE("Set algebra between containers") {
+    MagicalContainer left;
+    MagicalContainer right;
+    std::vector<int> leftValues = {5, 1, 3, 3, 7, 3};
+    std::vector<int> rightValues = {3, 8, 5, 3, 2};
+    left.addElements(leftValues);
+    right.addElements(rightValues);
+
+    auto elements = [](MagicalContainer &container) {
+        std::vector<int> seen;
+        MagicalContainer::AscendingIterator it(container);
+        for (auto at = it.begin(); at != it.end(); ++at)
+            seen.push_back(*at);
+        return seen;
+    };
+
+    MagicalContainer all = left.unionWith(right);
+    CHECK(elements(all) == std::vector<int>{1, 2, 3, 3, 3, 5, 7, 8});
+    MagicalContainer common = left.intersection(right);
+    CHECK(elements(common) == std::vector<int>{3, 3, 5});
+    MagicalContainer onlyLeft = left.difference(right);
+    CHECK(elements(onlyLeft) == std::vector<int>{1, 3, 7});
+    MagicalContainer either = left.symmetricDifference(right);
+    CHECK(elements(either) == std::vector<int>{1, 2, 3, 7, 8});
+
+    // the results have every view ready
+    MagicalContainer::PrimeIterator primes(all);
+    CHECK(*primes == 2);
+    MagicalContainer::SideCrossIterator cross(either);
+    CHECK(*cross == 1);
+    ++cross;
+    CHECK(*cross == 8);
+    all.addElement(4);
+    CHECK(elements(all) == std::vector<int>{1, 2, 3, 3, 3, 4, 5, 7, 8});
+
+    MagicalContainer empty;
+    CHECK(left.intersection(empty).size() == 0);
+    CHECK(empty.unionWith(right).size() == right.size());
+    CHECK(left.difference(left).size() == 0);
+}
+
+TEST_CASE("Content fingerprints") {
+    MagicalContainer first;
+    MagicalContainer second;
+    for (int value : {4, 9, 2, 9, 7}) {
+        first.addElement(value);
+    }
+    for (int value : {9, 2, 7, 4, 9}) {
+        second.addElement(value);
+    }
+
+    CHECK(first != second);
+    CHECK(first.fingerprint().ordered() != second.fingerprint().ordered());
+    CHECK(first.fingerprint().multiset() == second.fingerprint().multiset());
+    CHECK(first.sameElements(second));
+
+    SUBCASE("Removal keeps the hashes equal to a rebuild") {
+        first.removeElement(2);
+        first.removeElement(4);
+        MagicalContainer rebuilt;
+        for (int value : {9, 9, 7}) {
+            rebuilt.addElement(value);
+        }
+        CHECK(first.fingerprint().ordered() == rebuilt.fingerprint().ordered());
+        CHECK(first.fingerprint().multiset() == rebuilt.fingerprint().multiset());
+        CHECK(first == rebuilt);
+        CHECK_FALSE(first.sameElements(second));
+        rebuilt.addElement(1);
+        CHECK(first != rebuilt);
+    }
+
+    SUBCASE("Bulk paths, merges and set operations agree") {
+        std::vector<int> values = {4, 9, 2, 9, 7};
+        MagicalContainer bulk;
+        bulk.addElements(values);
+        CHECK(bulk == first);
+        CHECK(bulk.fingerprint().ordered() == first.fingerprint().ordered());
+
+        MagicalContainer merged = MagicalContainer::merged(first, second);
+        MagicalContainer appended(first);
+        for (int value : {9, 2, 7, 4, 9}) {
+            appended.addElement(value);
+        }
+        CHECK(merged.fingerprint().ordered() == appended.fingerprint().ordered());
+        CHECK(merged == appended);
+
+        MagicalContainer common = first.intersection(second);
+        CHECK(common.sameElements(first));
+        CHECK(common.fingerprint().multiset() == first.fingerprint().multiset());
+    }
+
+    SUBCASE("Snapshots keep the hashes") {
+        const std::string path = "magical_fingerprint_test.bin";
+        first.save(path);
+        MagicalContainer loaded = MagicalContainer::open(path);
+        CHECK(loaded.fingerprint().ordered() == first.fingerprint().ordered());
+        loaded.addElement(3);
+        first.addElement(3);
+        CHECK(loaded.fingerprint().ordered() == first.fingerprint().ordered());
+        CHECK(loaded == first);
+        std::remove(path.c_str());
+    }
+}
+
+TEST_CASE("Run-length compressed container") {
+    RunLengthContainer container;
+    std::vector<int> values = {7, 4, 7, 7, 2, 9, 4, 7, 1, 9};
+    container.addElements(values);
+    CHECK(container.size() == 10);
+    CHECK(container.distinct() == 5);
+
+    auto ascending = [](const RunLengthContainer &rle) {
+        std::vector<int> seen;
+        RunLengthContainer::AscendingIterator it(rle);
+        for (auto at = it.begin(); at != it.end(); ++at)
+            seen.push_back(*at);
+        return seen;
+    };
+    auto cross = [](const RunLengthContainer &rle) {
+        std::vector<int> seen;
+        RunLengthContainer::SideCrossIterator it(rle);
+        for (auto at = it.begin(); at != it.end(); ++at)
+            seen.push_back(*at);
+        return seen;
+    };
+    auto primes = [](const RunLengthContainer &rle) {
+        std::vector<int> seen;
+        RunLengthContainer::PrimeIterator it(rle);
+        for (auto at = it.begin(); at != it.end(); ++at)
+            seen.push_back(*at);
+        return seen;
+    };
+
+    SUBCASE("Iterators match the uncompressed container") {
+        MagicalContainer plain = container.expand();
+        MagicalContainer reference;
+        reference.addElements(values);
+        CHECK(plain == reference);
+        CHECK(ascending(container) == std::vector<int>{1, 2, 4, 4, 7, 7, 7, 7, 9, 9});
+        CHECK(cross(container) == std::vector<int>{1, 9, 2, 9, 4, 7, 4, 7, 7, 7});
+        CHECK(primes(container) == std::vector<int>{7, 7, 7, 2, 7});
+        CHECK(container.runs().size() == 5);
+        CHECK(container.runs()[3].value == 7);
+        CHECK(container.runs()[3].count == 4);
+
+        RunLengthContainer::AscendingIterator it(container);
+        CHECK_THROWS_AS(*it.end(), std::runtime_error);
+        CHECK_THROWS_AS(++it.end(), std::runtime_error);
+    }
+
+    SUBCASE("Removing occurrences and values") {
+        container.removeElement(7);
+        container.removeElement(1);
+        container.removeElement(2);
+        CHECK_THROWS_AS(container.removeElement(2), std::runtime_error);
+        CHECK(container.distinct() == 3);
+        CHECK(ascending(container) == std::vector<int>{4, 4, 7, 7, 7, 9, 9});
+        CHECK(primes(container) == std::vector<int>{7, 7, 7});
+        MagicalContainer reference;
+        for (int value : {4, 7, 7, 9, 4, 7, 9})
+            reference.addElement(value);
+        CHECK(container.expand() == reference);
+    }
+
+    SUBCASE("Memory scales with the distinct values") {
+        RunLengthContainer many;
+        for (int repeat = 0; repeat < 100; ++repeat)
+            for (int value = 0; value < 300; ++value)
+                many.addElement(value * 7);
+        CHECK(many.size() == 30000);
+        CHECK(many.distinct() == 300);
+        // 300 distinct values need 2-byte codes
+        CHECK(many.footprint().used < 30000 * 2 + 300 * 32);
+        RunLengthContainer::AscendingIterator it(many);
+        CHECK(*it == 0);
+        for (int value = 0; value < 200; ++value)
+            for (int repeat = 0; repeat < 100; ++repeat)
+                many.removeElement(value * 7);
+        CHECK(many.distinct() == 100);
+        // compacted back to 1-byte codes
+        CHECK(many.footprint().used < 10000 + 100 * 32);
+        RunLengthContainer::AscendingIterator rest(many);
+        CHECK(*rest == 1400);
+        RunLengthContainer::PrimeIterator prime(many);
+        CHECK_THROWS_AS(*prime, std::runtime_error);
+    }
+}
+
+TEST_CASE("Frozen containers") {
+    MagicalContainer container;
+    std::vector<int> values;
+    for (int i = 0; i < 1000; ++i)
+        values.push_back((i * 7919) % 2003 - 500);
+    values.push_back(-2000000000);
+    values.push_back(2000000000);
+    container.addElements(values);
+    FrozenContainer frozen = container.freeze();
+    CHECK(frozen.size() == container.size());
+
+    SUBCASE("Iterators decode the same elements") {
+        MagicalContainer::AscendingIterator expected(container);
+        FrozenContainer::AscendingIterator it(frozen);
+        auto at = expected.begin();
+        for (auto got = it.begin(); got != it.end(); ++got, ++at)
+            CHECK(*got == *at);
+        CHECK(at == expected.end());
+
+        MagicalContainer::SideCrossIterator expectedCross(container);
+        FrozenContainer::SideCrossIterator cross(frozen);
+        auto crossAt = expectedCross.begin();
+        for (auto got = cross.begin(); got != cross.end(); ++got, ++crossAt)
+            CHECK(*got == *crossAt);
+
+        std::vector<int> primes;
+        MagicalContainer::PrimeIterator expectedPrimes(container);
+        for (auto prime = expectedPrimes.begin(); prime != expectedPrimes.end(); ++prime)
+            primes.push_back(*prime);
+        std::sort(primes.begin(), primes.end());
+        std::vector<int> frozenPrimes;
+        FrozenContainer::PrimeIterator prime(frozen);
+        for (auto got = prime.begin(); got != prime.end(); ++got)
+            frozenPrimes.push_back(*got);
+        CHECK(frozenPrimes == primes);
+        CHECK_THROWS_AS(*prime.end(), std::runtime_error);
+    }
+
+    SUBCASE("Smaller than the element array") {
+        CHECK(frozen.footprint().used < container.size() * sizeof(int));
+    }
+
+    SUBCASE("Empty and 64-bit containers") {
+        MagicalContainer empty;
+        FrozenContainer none = empty.freeze();
+        FrozenContainer::AscendingIterator it(none);
+        CHECK(it.begin() == it.end());
+        FrozenContainer::PrimeIterator prime(none);
+        CHECK(prime.begin() == prime.end());
+
+        BasicMagicalContainer<std::uint64_t> wide;
+        std::vector<std::uint64_t> wideValues = {0, 18446744073709551557ULL, 3, UINT64_MAX};
+        wide.addElements(wideValues);
+        BasicFrozenContainer<std::uint64_t> wideFrozen = wide.freeze();
+        BasicFrozenContainer<std::uint64_t>::SideCrossIterator cross(wideFrozen);
+        CHECK(*cross == 0);
+        ++cross;
+        CHECK(*cross == UINT64_MAX);
+        BasicFrozenContainer<std::uint64_t>::PrimeIterator widePrime(wideFrozen);
+        CHECK(*widePrime == 3);
+        ++widePrime;
+        CHECK(*widePrime == 18446744073709551557ULL);
+    }
+
+    CHECK_THROWS_AS(FrozenContainer(std::vector<int>{3, 1}, std::vector<std::uint8_t>{0, 0}), std::invalid_argument);
+}
+
+TEST_CASE("Batch fetching") {
+    MagicalContainer container;
+    std::vector<int> values = {10, 3, 7, 1, 8, 5, 2};
+    container.addElements(values);
+    std::vector<int> buffer(3);
+
+    SUBCASE("Ascending batches") {
+        MagicalContainer::AscendingIterator it(container);
+        CHECK(it.fetchBatch(buffer) == 3);
+        CHECK(buffer == std::vector<int>{1, 2, 3});
+        CHECK(*it == 5);
+        CHECK(it.fetchBatch(buffer) == 3);
+        CHECK(buffer == std::vector<int>{5, 7, 8});
+        CHECK(it.fetchBatch(buffer) == 1);
+        CHECK(buffer[0] == 10);
+        CHECK(it == it.end());
+        CHECK(it.fetchBatch(buffer) == 0);
+    }
+
+    SUBCASE("Cross, prime and view batches") {
+        MagicalContainer::SideCrossIterator cross(container);
+        std::vector<int> all(10);
+        CHECK(cross.fetchBatch(all) == 7);
+        all.resize(7);
+        CHECK(all == std::vector<int>{1, 10, 2, 8, 3, 7, 5});
+
+        MagicalContainer::PrimeIterator primes(container);
+        ++primes;
+        CHECK(primes.fetchBatch(buffer) == 3);
+        CHECK(buffer == std::vector<int>{7, 5, 2});
+
+        MagicalContainer::FilterIterator<IsEven> evens(container);
+        CHECK(evens.fetchBatch(buffer) == 3);
+        CHECK(buffer == std::vector<int>{10, 8, 2});
+    }
+}
+
+// Test case for the parallel traversal of the views
+TEST_CASE("Parallel forEach and reduce") {
+    ThreadPool pool(3);
+    MagicalContainer container;
+    std::vector<int> values(100000);
+    for (size_t i = 0; i < values.size(); ++i)
+        values[i] = static_cast<int>(values.size() - i);
+    container.addElements(values);
+
+    SUBCASE("Reduce visits every element once, in traversal order") {
+        MagicalContainer::AscendingIterator ascending(container);
+        CHECK(parallelReduce(ascending, std::int64_t(0), std::plus<>(), pool) == std::int64_t(100000) * 100001 / 2);
+
+        // joining intervals is associative but not commutative, so the chunk order shows
+        struct Interval {
+            int first;
+            int last;
+            bool contiguous = true;
+            Interval(int value) : first(value), last(value) {}
+        };
+        auto join = [](Interval left, const Interval &right) {
+            left.contiguous = left.contiguous && right.contiguous && left.last + 1 == right.first;
+            left.last = right.last;
+            return left;
+        };
+        Interval joined = parallelReduce(ascending, Interval(0), join, pool);
+        CHECK(joined.contiguous);
+        CHECK(joined.last == 100000);
+    }
+
+    SUBCASE("forEach covers all the views") {
+        std::atomic<std::int64_t> sum{0};
+        std::atomic<size_t> count{0};
+        auto visit = [&](int value) { sum += value; ++count; };
+
+        MagicalContainer::SideCrossIterator cross(container);
+        parallelForEach(cross, visit, pool);
+        CHECK(count == 100000);
+        CHECK(sum == std::int64_t(100000) * 100001 / 2);
+
+        count = 0;
+        MagicalContainer::PrimeIterator primes(container);
+        parallelForEach(primes, [&](int) { ++count; }, pool);
+        CHECK(count == 9592);
+
+        std::int64_t evens = parallelReduce(MagicalContainer::FilterIterator<IsEven>(container), std::int64_t(0), std::plus<>(), pool);
+        CHECK(evens == std::int64_t(50000) * 50001);
+    }
+
+    SUBCASE("Empty views and the shared pool") {
+        MagicalContainer empty;
+        MagicalContainer::AscendingIterator ascending(empty);
+        bool called = false;
+        parallelForEach(ascending, [&](int) { called = true; });
+        CHECK_FALSE(called);
+        CHECK(parallelReduce(ascending, 7, std::plus<>()) == 7);
+    }
+
+    SUBCASE("Exceptions reach the caller") {
+        MagicalContainer::AscendingIterator ascending(container);
+        CHECK_THROWS_AS(parallelForEach(ascending, [](int value) { if (value == 77777) throw std::runtime_error("stop"); }, pool), std::runtime_error);
+        // the pool keeps working afterwards
+        CHECK(parallelReduce(ascending, 0, [](int best, int value) { return std::max(best, value); }, pool) == 100000);
+    }
+}
+
+// Test case for splitting the views into sub-ranges
+TEST_CASE("Splitting views into ranges") {
+    MagicalContainer container;
+    for (int i = 1; i <= 10; ++i)
+        container.addElement(i);
+
+    SUBCASE("Sub-ranges are balanced and cover the traversal in order") {
+        MagicalContainer::AscendingIterator ascending(container);
+        auto ranges = ascending.split(3);
+        REQUIRE(ranges.size() == 3);
+        CHECK(ranges[0].size() == 4);
+        CHECK(ranges[1].size() == 3);
+        CHECK(ranges[2].size() == 3);
+        std::vector<int> seen;
+        for (const auto &range : ranges)
+            for (int value : range)
+                seen.push_back(value);
+        CHECK(seen == std::vector<int>{1, 2, 3, 4, 5, 6, 7, 8, 9, 10});
+        CHECK(ranges[2].end() == ascending.end());
+    }
+
+    SUBCASE("Every view can be split") {
+        MagicalContainer::SideCrossIterator cross(container);
+        auto crossRanges = cross.split(2);
+        CHECK(*crossRanges[1].begin() == 8);
+
+        MagicalContainer::PrimeIterator primes(container);
+        auto primeRanges = primes.split(2);
+        CHECK(*primeRanges[0].begin() == 2);
+        CHECK(*primeRanges[1].begin() == 5);
+
+        MagicalContainer::FilterIterator<IsEven> evens(container);
+        auto evenRanges = evens.split(5);
+        CHECK(evenRanges.size() == 5);
+        CHECK(*evenRanges[4].begin() == 10);
+
+        // a range of values splits the same way
+        auto middle = container.range(3, 9).split(2);
+        CHECK(*middle[1].begin() == 6);
+        CHECK(middle[1].size() == 3);
+    }
+
+    SUBCASE("More parts than elements, and 0 parts") {
+        MagicalContainer::PrimeIterator primes(container);
+        auto ranges = primes.split(6);
+        CHECK(ranges.size() == 6);
+        CHECK(ranges[3].size() == 1);
+        CHECK(ranges[4].empty());
+        CHECK(ranges[5].begin() == primes.end());
+        CHECK_THROWS_AS(primes.split(0), std::invalid_argument);
+    }
+}
+
+// Test case for the lazy generator sequences
+TEST_CASE("Generator sequences") {
+    MagicalContainer container;
+    for (int value : {7, 4, 10, 3, 8, 5, 2})
+        container.addElement(value);
+
+    SUBCASE("Every order is produced") {
+        std::vector<int> ascending, cross, primes;
+        for (int value : container.ascending())
+            ascending.push_back(value);
+        for (int value : container.sideCross())
+            cross.push_back(value);
+        for (int value : container.primes())
+            primes.push_back(value);
+        CHECK(ascending == std::vector<int>{2, 3, 4, 5, 7, 8, 10});
+        CHECK(cross == std::vector<int>{2, 10, 3, 8, 4, 7, 5});
+        CHECK(primes == std::vector<int>{7, 3, 5, 2});
+
+        auto empty = MagicalContainer().ascending();
+        CHECK(empty.begin() == empty.end());
+    }
+
+    SUBCASE("Pipelines compose and stop early") {
+        std::vector<int> picked;
+        for (int value : container.ascendingFrom(4) | std::views::filter(IsPrime()) | std::views::take(2))
+            picked.push_back(value);
+        CHECK(picked == std::vector<int>{5, 7});
+
+        // the generator runs only as far as it is read
+        MagicalContainer large;
+        std::vector<int> values(200000);
+        for (size_t i = 0; i < values.size(); ++i)
+            values[i] = static_cast<int>(i);
+        large.addElements(values);
+        size_t tested = 0;
+        auto counted = [&tested](int value) { ++tested; return IsPrime()(value); };
+        picked.clear();
+        for (int value : large.ascendingFrom(1000) | std::views::filter(counted) | std::views::filter(IsOdd()) | std::views::take(3))
+            picked.push_back(value);
+        CHECK(picked == std::vector<int>{1009, 1013, 1019});
+        CHECK(tested < 100);
+    }
+
+    SUBCASE("A sequence keeps reading the elements it started with") {
+        auto sequence = container.ascending();
+        auto it = sequence.begin();
+        CHECK(*it == 2);
+        container.removeElement(3);
+        container.addElement(1);
+        std::vector<int> rest;
+        for (++it; it != sequence.end(); ++it)
+            rest.push_back(*it);
+        CHECK(rest == std::vector<int>{3, 4, 5, 7, 8, 10});
+        CHECK(*container.ascending().begin() == 1);
+    }
+}
+
+// Test case for the container maintained by a background thread
+TEST_CASE("Background maintenance") {
+    BackgroundContainer container;
+    CHECK(container.size() == 0);
+    CHECK(container.version() == 0);
+
+    SUBCASE("Logged mutations are published by flush") {
+        for (int i = 1; i <= 1000; ++i)
+            container.addElement(i);
+        container.removeElement(500);
+        container.flush();
+        CHECK(container.pending() == 0);
+        CHECK(container.size() == 999);
+        CHECK(container.version() >= 1);
+
+        MagicalContainer published = container.snapshot();
+        MagicalContainer::AscendingIterator ascending(published);
+        CHECK(*ascending == 1);
+        MagicalContainer::PrimeIterator primes(published);
+        CHECK(*primes == 2);
+        CHECK(published.countInRange(495, 505) == 10);
+    }
+
+    SUBCASE("A snapshot does not change after later mutations") {
+        std::vector<int> values{5, 3, 8};
+        container.addElements(values);
+        container.flush();
+        MagicalContainer before = container.snapshot();
+        container.addElement(1);
+        container.removeElement(8);
+        container.flush();
+
+        std::vector<int> seen;
+        for (int value : before.ascending())
+            seen.push_back(value);
+        CHECK(seen == std::vector<int>{3, 5, 8});
+        std::vector<int> now;
+        for (int value : container.snapshot().ascending())
+            now.push_back(value);
+        CHECK(now == std::vector<int>{1, 3, 5});
+    }
+
+    SUBCASE("Errors of logged operations are reported once") {
+        container.addElement(4);
+        container.removeElement(9);
+        container.addElement(6);
+        CHECK_THROWS_AS(container.flush(), std::runtime_error);
+        CHECK(container.size() == 2);
+        CHECK_NOTHROW(container.flush());
+    }
+
+    SUBCASE("Readers run while the log is applied") {
+        std::atomic<bool> done{false};
+        bool consistent = true;
+        std::thread reader([&] {
+            while (!done)
+            {
+                MagicalContainer published = container.snapshot();
+                MagicalContainer::AscendingIterator it(published);
+                size_t count = 0;
+                for (auto value = it.begin(); value != it.end(); ++value)
+                    ++count;
+                consistent = consistent && count == published.size();
+            }
+        });
+        for (int i = 0; i < 2000; ++i)
+            container.addElement(i % 97);
+        container.flush();
+        done = true;
+        reader.join();
+        CHECK(consistent);
+        CHECK(container.size() == 2000);
+    }
+}
+
+// Test case for the container sharded by value range
+TEST_CASE("Range-sharded container") {
+    std::vector<int> boundaries{10, 20, 30};
+    RangeShardedContainer container(boundaries);
+    CHECK(container.shards() == 4);
+    CHECK(container.shardOf(-5) == 0);
+    CHECK(container.shardOf(10) == 1);
+    CHECK(container.shardOf(29) == 2);
+    CHECK(container.shardOf(1000) == 3);
+
+    SUBCASE("Ascending order concatenates the shards") {
+        for (int value : {25, 3, 40, 12, 7, 31, 19})
+            container.addElement(value);
+        CHECK(container.size() == 7);
+        CHECK(container.shard(1).size() == 2);
+        CHECK(container.shard(2).size() == 1);
+
+        std::vector<int> seen;
+        RangeShardedContainer::AscendingIterator it(container);
+        for (auto value = it.begin(); value != it.end(); ++value)
+            seen.push_back(*value);
+        CHECK(seen == std::vector<int>{3, 7, 12, 19, 25, 31, 40});
+
+        container.removeElement(25);
+        seen.clear();
+        for (auto value = it.begin(); value != it.end(); ++value)
+            seen.push_back(*value);
+        CHECK(seen == std::vector<int>{3, 7, 12, 19, 31, 40});
+        CHECK_THROWS_AS(container.removeElement(25), std::runtime_error);
+        CHECK_THROWS_AS(*it.end(), std::runtime_error);
+    }
+
+    SUBCASE("Empty shards are skipped") {
+        RangeShardedContainer::AscendingIterator empty(container);
+        CHECK(empty.begin() == empty.end());
+        container.addElement(35);
+        RangeShardedContainer::AscendingIterator it(container);
+        CHECK(*it == 35);
+        CHECK_FALSE(++it < it.end());
+    }
+
+    SUBCASE("Concurrent inserts and parallel scans") {
+        std::vector<int> even = RangeShardedContainer::evenBoundaries(8, 0, 7999);
+        CHECK(even == std::vector<int>{1000, 2000, 3000, 4000, 5000, 6000, 7000});
+        RangeShardedContainer sharded(even);
+        std::vector<std::thread> writers;
+        for (int w = 0; w < 4; ++w)
+            writers.emplace_back([&sharded, w] {
+                for (int i = w; i < 8000; i += 4)
+                    sharded.addElement(i);
+            });
+        for (auto &writer : writers)
+            writer.join();
+        CHECK(sharded.size() == 8000);
+
+        ThreadPool pool(3);
+        std::atomic<std::int64_t> sum{0};
+        parallelForEach(sharded, [&](int value) { sum += value; }, pool);
+        CHECK(sum == std::int64_t(7999) * 8000 / 2);
+
+        // folding in shard order keeps the ascending order
+        struct Run {
+            int first;
+            int last;
+            bool ascending = true;
+            Run(int value) : first(value), last(value) {}
+        };
+        auto join = [](Run left, const Run &right) {
+            left.ascending = left.ascending && right.ascending && left.last < right.first;
+            left.last = right.last;
+            return left;
+        };
+        Run run = parallelReduce(sharded, Run(-1), join, pool);
+        CHECK(run.last == 7999);
+        CHECK(run.ascending);
+    }
+
+    SUBCASE("Bulk inserts and invalid boundaries") {
+        std::vector<int> values{50, 5, 15, 15, 22};
+        container.addElements(values);
+        CHECK(container.size() == 5);
+        CHECK(container.shard(1).size() == 2);
+        std::vector<int> unsorted{5, 5};
+        CHECK_THROWS_AS(RangeShardedContainer{unsorted}, std::invalid_argument);
+        CHECK_THROWS_AS(RangeShardedContainer::evenBoundaries(0, 0, 10), std::invalid_argument);
+        CHECK(RangeShardedContainer::evenBoundaries(1, 0, 10).empty());
+        // every shard gets at least one value, or the range is rejected
+        CHECK(RangeShardedContainer::evenBoundaries(4, 0, 3) == std::vector<int>{1, 2, 3});
+        CHECK(RangeShardedContainer::evenBoundaries(3, 0, 9) == std::vector<int>{4, 7});
+        CHECK_THROWS_AS(RangeShardedContainer::evenBoundaries(5, 0, 3), std::invalid_argument);
+        CHECK_THROWS_AS(RangeShardedContainer::evenBoundaries(2, 7, 7), std::invalid_argument);
+        CHECK(BasicRangeShardedContainer<std::uint32_t>::evenBoundaries(2, 0, 4294967295U) == std::vector<std::uint32_t>{2147483648U});
+    }
+}
+
+// Test case for the container sharded by hash
+TEST_CASE("Hash-sharded container") {
+    SUBCASE("The merged orders match a single container") {
+        for (size_t shards : {1U, 2U, 3U, 8U})
+        {
+            HashShardedContainer sharded(shards);
+            MagicalContainer single;
+            unsigned seed = 7;
+            for (int i = 0; i < 500; ++i)
+            {
+                seed = seed * 1103515245 + 12345;
+                int value = static_cast<int>(seed >> 16U) % 200 - 100;
+                sharded.addElement(value);
+                single.addElement(value);
+            }
+            sharded.removeElement(single.kthSmallest(0));
+            single.removeElement(single.kthSmallest(0));
+            CHECK(sharded.size() == single.size());
+
+            std::vector<int> merged, expected;
+            HashShardedContainer::AscendingIterator ascending(sharded);
+            for (auto it = ascending.begin(); it != ascending.end(); ++it)
+                merged.push_back(*it);
+            MagicalContainer::AscendingIterator reference(single);
+            for (auto it = reference.begin(); it != reference.end(); ++it)
+                expected.push_back(*it);
+            CHECK(merged == expected);
+
+            merged.clear();
+            expected.clear();
+            HashShardedContainer::SideCrossIterator cross(sharded);
+            for (auto it = cross.begin(); it != cross.end(); ++it)
+                merged.push_back(*it);
+            MagicalContainer::SideCrossIterator referenceCross(single);
+            for (auto it = referenceCross.begin(); it != referenceCross.end(); ++it)
+                expected.push_back(*it);
+            CHECK(merged == expected);
+        }
+    }
+
+    SUBCASE("Crowded values spread over the shards") {
+        HashShardedContainer sharded(4);
+        std::vector<int> values(4000);
+        for (size_t i = 0; i < values.size(); ++i)
+            values[i] = static_cast<int>(i);
+        sharded.addElements(values);
+        for (size_t i = 0; i < sharded.shards(); ++i)
+        {
+            CHECK(sharded.shard(i).size() > 800);
+            CHECK(sharded.shard(i).size() < 1200);
+        }
+        CHECK(sharded.shardOf(42) == sharded.shardOf(42));
+    }
+
+    SUBCASE("Empty shards, errors and ends") {
+        HashShardedContainer sharded(5);
+        HashShardedContainer::AscendingIterator empty(sharded);
+        CHECK(empty.begin() == empty.end());
+        CHECK_THROWS_AS(*empty, std::runtime_error);
+        sharded.addElement(3);
+        HashShardedContainer::SideCrossIterator cross(sharded);
+        CHECK(*cross == 3);
+        CHECK(++cross == cross.end());
+        CHECK_THROWS_AS(++cross, std::runtime_error);
+        CHECK_THROWS_AS(sharded.removeElement(4), std::runtime_error);
+        CHECK_THROWS_AS(HashShardedContainer(0), std::invalid_argument);
+        HashShardedContainer other(5);
+        CHECK_THROWS_AS((void)(HashShardedContainer::AscendingIterator(other) == empty), std::invalid_argument);
+    }
+}
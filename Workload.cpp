@@ -0,0 +1,192 @@
+#include "Workload.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <stdexcept>
+
+#include "sources/ElementTraits.hpp"
+
+using namespace ariel::workload;
+
+namespace
+{
+    // Portable draws on top of the raw engine output
+    class Source
+    {
+        std::mt19937_64 random;
+
+    public:
+        explicit Source(std::uint64_t seed) : random(seed) {}
+
+        std::uint64_t below(std::uint64_t bound)
+        {
+            return random() % bound;
+        }
+
+        double unit()
+        {
+            return static_cast<double>(random() >> 11U) * 0x1.0p-53;
+        }
+
+        int between(int low, int high)
+        {
+            auto span = static_cast<std::uint64_t>(static_cast<std::int64_t>(high) - low) + 1;
+            return static_cast<int>(low + static_cast<std::int64_t>(below(span)));
+        }
+    };
+
+    bool isPrime(int value)
+    {
+        return ariel::ElementTraits<int>::isPrime(value);
+    }
+
+    // Draw a value with the wanted primality, giving up after a bounded number of tries
+    // for ranges that have (almost) no values of that kind
+    int drawWithPrimality(Source &source, const Config &config, bool prime)
+    {
+        int value = source.between(config.minValue, config.maxValue);
+        for (int attempt = 0; attempt < 1000 && isPrime(value) != prime; ++attempt)
+            value = source.between(config.minValue, config.maxValue);
+        return value;
+    }
+
+    std::vector<int> hotValues(Source &source, const Config &config)
+    {
+        std::vector<int> hot(std::max<size_t>(1, config.distinct));
+        for (int &value : hot)
+            value = source.between(config.minValue, config.maxValue);
+        return hot;
+    }
+}
+
+std::vector<int> ariel::workload::values(const Config &config, size_t count)
+{
+    if (config.minValue > config.maxValue)
+        throw std::invalid_argument("Workload value range is empty");
+
+    Source source(config.seed);
+    std::vector<int> result(count);
+
+    switch (config.distribution)
+    {
+    case Distribution::Uniform:
+    case Distribution::Sorted:
+    case Distribution::ReverseSorted:
+        for (int &value : result)
+            value = source.between(config.minValue, config.maxValue);
+        if (config.distribution == Distribution::Sorted)
+            std::sort(result.begin(), result.end());
+        if (config.distribution == Distribution::ReverseSorted)
+            std::sort(result.begin(), result.end(), std::greater<>());
+        break;
+
+    case Distribution::Zipfian:
+    {
+        std::vector<int> hot = hotValues(source, config);
+        std::vector<double> cumulative(hot.size());
+        double total = 0;
+        for (size_t rank = 0; rank < hot.size(); ++rank)
+        {
+            total += 1.0 / std::pow(static_cast<double>(rank + 1), config.skew);
+            cumulative[rank] = total;
+        }
+        for (int &value : result)
+        {
+            auto rank = std::upper_bound(cumulative.begin(), cumulative.end(), source.unit() * total) - cumulative.begin();
+            value = hot[std::min(static_cast<size_t>(rank), hot.size() - 1)];
+        }
+        break;
+    }
+
+    case Distribution::HeavyDuplicate:
+    {
+        std::vector<int> hot = hotValues(source, config);
+        for (int &value : result)
+            value = hot[source.below(hot.size())];
+        break;
+    }
+
+    case Distribution::PrimeDense:
+        for (int &value : result)
+            value = drawWithPrimality(source, config, source.unit() < 0.9);
+        break;
+
+    case Distribution::PrimeSparse:
+        for (int &value : result)
+            value = drawWithPrimality(source, config, source.unit() < 0.01);
+        break;
+    }
+    return result;
+}
+
+std::vector<Operation> ariel::workload::operations(const Config &config, const Mix &mix, size_t count)
+{
+    double total = mix.add + mix.remove + mix.iterate;
+    if (!(total > 0))
+        throw std::invalid_argument("Workload mix has no operations");
+
+    std::vector<int> added = values(config, count);
+    Source source(config.seed ^ 0x9E3779B97F4A7C15ULL);
+    std::vector<int> live;
+    std::vector<Operation> result;
+    result.reserve(count);
+    size_t nextAdded = 0;
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        double pick = source.unit() * total;
+        if (pick >= mix.add && pick < mix.add + mix.remove && !live.empty())
+        {
+            size_t victim = source.below(live.size());
+            result.push_back({Operation::Kind::Remove, live[victim]});
+            live[victim] = live.back();
+            live.pop_back();
+        }
+        else if (pick >= mix.add + mix.remove)
+        {
+            result.push_back({Operation::Kind::Iterate, 0});
+        }
+        else
+        {
+            int value = added[nextAdded++];
+            live.push_back(value);
+            result.push_back({Operation::Kind::Add, value});
+        }
+    }
+    return result;
+}
+
+std::string ariel::workload::name(Distribution distribution)
+{
+    switch (distribution)
+    {
+    case Distribution::Uniform:
+        return "uniform";
+    case Distribution::Zipfian:
+        return "zipfian";
+    case Distribution::Sorted:
+        return "sorted";
+    case Distribution::ReverseSorted:
+        return "reverse-sorted";
+    case Distribution::HeavyDuplicate:
+        return "heavy-duplicate";
+    case Distribution::PrimeDense:
+        return "prime-dense";
+    case Distribution::PrimeSparse:
+        return "prime-sparse";
+    }
+    return "unknown";
+}
+
+Distribution ariel::workload::parseDistribution(const std::string &text)
+{
+    for (auto distribution : {Distribution::Uniform, Distribution::Zipfian, Distribution::Sorted,
+                              Distribution::ReverseSorted, Distribution::HeavyDuplicate,
+                              Distribution::PrimeDense, Distribution::PrimeSparse})
+    {
+        if (name(distribution) == text)
+            return distribution;
+    }
+    throw std::invalid_argument("Unknown workload distribution: " + text);
+}
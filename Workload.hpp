@@ -0,0 +1,96 @@
+/**
+ * @file Workload.hpp
+ * @brief Seeded synthetic workloads for benchmarking MagicalContainer.
+ * @details Generates element streams with the value distributions that matter to the
+ * container (uniform, Zipfian, already sorted, reverse sorted, heavy duplicates, prime
+ * dense and prime sparse) and replayable add/remove/iterate operation mixes.
+ * The generators use their own arithmetic on top of std::mt19937_64 instead of the
+ * standard distributions, so a seed produces the same workload with every standard library.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace ariel::workload
+{
+    /**
+     * @brief The shape of a generated value stream.
+     */
+    enum class Distribution
+    {
+        Uniform,        // independent values in [minValue, maxValue]
+        Zipfian,        // `distinct` hot values, the k-th most frequent with weight 1 / k^skew
+        Sorted,         // non-decreasing values spread over [minValue, maxValue]
+        ReverseSorted,  // non-increasing values spread over [minValue, maxValue]
+        HeavyDuplicate, // `distinct` values repeated uniformly
+        PrimeDense,     // 90% primes
+        PrimeSparse     // 1% primes
+    };
+
+    /**
+     * @brief Parameters of a value stream.
+     */
+    struct Config
+    {
+        Distribution distribution = Distribution::Uniform;
+        int minValue = 0;
+        int maxValue = 1000000000;
+        size_t distinct = 256; // distinct values of the Zipfian and heavy-duplicate streams
+        double skew = 1.0;     // Zipfian exponent
+        std::uint64_t seed = 20230612;
+    };
+
+    /**
+     * @brief Relative weights of the operations of a mixed workload.
+     */
+    struct Mix
+    {
+        double add = 0.7;
+        double remove = 0.2;
+        double iterate = 0.1;
+    };
+
+    /**
+     * @brief One step of a mixed workload.
+     */
+    struct Operation
+    {
+        enum class Kind
+        {
+            Add,
+            Remove,
+            Iterate
+        };
+
+        Kind kind;
+        int value; // the element added or removed, unused for Iterate
+    };
+
+    /**
+     * @brief Generate `count` values.
+     */
+    std::vector<int> values(const Config &config, size_t count);
+
+    /**
+     * @brief Generate `count` operations starting from an empty container.
+     * @details Removals always name an element that is present at that point of the
+     * replay; when the container would be empty an Add is generated instead.
+     */
+    std::vector<Operation> operations(const Config &config, const Mix &mix, size_t count);
+
+    /**
+     * @brief The name of a distribution, as accepted by parseDistribution().
+     */
+    std::string name(Distribution distribution);
+
+    /**
+     * @brief Parse a distribution name such as "zipfian" or "reverse-sorted".
+     * @throws std::invalid_argument for unknown names.
+     */
+    Distribution parseDistribution(const std::string &text);
+}
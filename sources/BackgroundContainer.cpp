@@ -0,0 +1,180 @@
+#include "BackgroundContainer.hpp"
+#include <utility>
+
+using namespace ariel;
+using namespace std;
+
+// Publish the empty container and start the maintenance thread
+template <typename T>
+BasicBackgroundContainer<T>::BasicBackgroundContainer(std::pmr::memory_resource *resource)
+    : shadow(resource), published(std::make_shared<const container_type>(shadow))
+{
+    maintenance = std::thread([this]
+                              { maintain(); });
+}
+
+// Drain the log and join the maintenance thread
+template <typename T>
+BasicBackgroundContainer<T>::~BasicBackgroundContainer()
+{
+    {
+        std::lock_guard<std::mutex> lock(logMutex);
+        stopping = true;
+    }
+    logged.notify_one();
+    maintenance.join();
+}
+
+// Append to the mutation log and wake the maintenance thread
+template <typename T>
+void BasicBackgroundContainer<T>::append(std::span<const Mutation> mutations)
+{
+    {
+        std::lock_guard<std::mutex> lock(logMutex);
+        log.insert(log.end(), mutations.begin(), mutations.end());
+    }
+    logged.notify_one();
+}
+
+// Apply a batch to the shadow, keeping the first error
+template <typename T>
+void BasicBackgroundContainer<T>::apply(const std::vector<Mutation> &batch)
+{
+    std::exception_ptr error;
+    auto attempt = [&](auto &&operation)
+    {
+        try
+        {
+            operation();
+        }
+        catch (...)
+        {
+            if (!error)
+                error = std::current_exception();
+        }
+    };
+
+    // consecutive additions go through the bulk path together
+    std::vector<T> additions;
+    auto addPending = [&]
+    {
+        if (!additions.empty())
+            attempt([&]
+                    { shadow.addElements(additions); });
+        additions.clear();
+    };
+    for (const Mutation &mutation : batch)
+    {
+        if (!mutation.remove)
+        {
+            additions.push_back(mutation.value);
+            continue;
+        }
+        addPending();
+        attempt([&]
+                { shadow.removeElement(mutation.value); });
+    }
+    addPending();
+
+    if (error)
+    {
+        std::lock_guard<std::mutex> lock(logMutex);
+        if (!failure)
+            failure = error;
+    }
+}
+
+// Maintenance loop: take the log, apply it to the shadow, publish a copy
+template <typename T>
+void BasicBackgroundContainer<T>::maintain()
+{
+    while (true)
+    {
+        std::vector<Mutation> batch;
+        {
+            std::unique_lock<std::mutex> lock(logMutex);
+            logged.wait(lock, [this]
+                        { return stopping || !log.empty(); });
+            if (log.empty())
+                return;
+            batch.swap(log);
+            applying = true;
+        }
+
+        apply(batch);
+        published.store(std::make_shared<const container_type>(shadow));
+        publishedVersion.fetch_add(1);
+
+        {
+            std::lock_guard<std::mutex> lock(logMutex);
+            applying = false;
+        }
+        applied.notify_all();
+    }
+}
+
+// Log one addition
+template <typename T>
+void BasicBackgroundContainer<T>::addElement(T element)
+{
+    Mutation mutation{element, false};
+    append(std::span<const Mutation>(&mutation, 1));
+}
+
+// Log many additions
+template <typename T>
+void BasicBackgroundContainer<T>::addElements(std::span<const T> elements)
+{
+    std::vector<Mutation> mutations;
+    mutations.reserve(elements.size());
+    for (T element : elements)
+        mutations.push_back({element, false});
+    append(mutations);
+}
+
+// Log one removal
+template <typename T>
+void BasicBackgroundContainer<T>::removeElement(T element)
+{
+    Mutation mutation{element, true};
+    append(std::span<const Mutation>(&mutation, 1));
+}
+
+// Wait for the log to be applied and published
+template <typename T>
+void BasicBackgroundContainer<T>::flush()
+{
+    std::unique_lock<std::mutex> lock(logMutex);
+    applied.wait(lock, [this]
+                 { return log.empty() && !applying; });
+    if (failure)
+        std::rethrow_exception(std::exchange(failure, nullptr));
+}
+
+// O(1) copy of the last published version
+template <typename T>
+typename BasicBackgroundContainer<T>::container_type BasicBackgroundContainer<T>::snapshot() const
+{
+    return *published.load();
+}
+
+// Size of the last published version
+template <typename T>
+size_t BasicBackgroundContainer<T>::size() const
+{
+    return published.load()->size();
+}
+
+// Length of the log
+template <typename T>
+size_t BasicBackgroundContainer<T>::pending() const
+{
+    std::lock_guard<std::mutex> lock(logMutex);
+    return log.size();
+}
+
+// The element types the container is compiled for
+template class ariel::BasicBackgroundContainer<int>;
+template class ariel::BasicBackgroundContainer<std::uint32_t>;
+template class ariel::BasicBackgroundContainer<std::int64_t>;
+template class ariel::BasicBackgroundContainer<std::uint64_t>;
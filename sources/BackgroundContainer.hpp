@@ -0,0 +1,148 @@
+/**
+ * @file BackgroundContainer.hpp
+ * @brief Defines a MagicalContainer whose views are maintained by a background thread.
+ * @details BasicBackgroundContainer keeps the add and remove operations off the caller's
+ * latency path: they only append to a mutation log and return. A maintenance thread takes
+ * the whole log as a batch, applies it to a shadow container (consecutive additions through
+ * the bulk addElements path, so the views are updated once per run), and then publishes a
+ * copy of the shadow with an atomic swap. Publishing is O(1) because the storage is shared
+ * copy-on-write; the next batch copies it before changing it, so the published version is
+ * never modified. Readers take a snapshot of the last published version and iterate it as
+ * an ordinary MagicalContainer, without any lock.
+ *
+ * @author Maya Rom
+ * @ID 207485251
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <span>
+#include <thread>
+#include <vector>
+
+#include "MagicalContainer.hpp"
+
+namespace ariel
+{
+    /**
+     * @class BasicBackgroundContainer
+     * @brief A MagicalContainer updated asynchronously from a mutation log.
+     * @tparam T The integer element type.
+     */
+    template <typename T>
+    class BasicBackgroundContainer
+    {
+    public:
+        using value_type = T;
+        using container_type = BasicMagicalContainer<T>;
+
+    private:
+        /**
+         * @brief One logged operation.
+         */
+        struct Mutation
+        {
+            T value;
+            bool remove;
+        };
+
+        container_type shadow; // only touched by the maintenance thread
+        std::atomic<std::shared_ptr<const container_type>> published;
+        std::atomic<std::uint64_t> publishedVersion{0};
+
+        mutable std::mutex logMutex;
+        std::condition_variable logged;  // signalled when the log grows or on shutdown
+        std::condition_variable applied; // signalled when a batch is published
+        std::vector<Mutation> log;
+        bool applying = false;
+        bool stopping = false;
+        std::exception_ptr failure; // the first error of a logged operation, reported by flush()
+
+        std::thread maintenance;
+
+        void append(std::span<const Mutation> mutations);
+        void apply(const std::vector<Mutation> &batch);
+        void maintain();
+
+    public:
+        /**
+         * @brief Constructs an empty container and starts its maintenance thread.
+         * @param resource The memory resource of the shadow and published containers.
+         */
+        explicit BasicBackgroundContainer(std::pmr::memory_resource *resource = std::pmr::get_default_resource());
+
+        /**
+         * @brief Apply the mutations still in the log, then stop the maintenance thread.
+         */
+        ~BasicBackgroundContainer();
+
+        BasicBackgroundContainer(const BasicBackgroundContainer &) = delete;
+        BasicBackgroundContainer &operator=(const BasicBackgroundContainer &) = delete;
+
+        /**
+         * @brief Log the addition of an element and return without waiting for it.
+         * @param element The element to add.
+         */
+        void addElement(T element);
+
+        /**
+         * @brief Log the addition of many elements, in order.
+         * @param elements The elements to add.
+         */
+        void addElements(std::span<const T> elements);
+
+        /**
+         * @brief Log the removal of an element and return without waiting for it.
+         * @details A removal of an element that is not in the container is reported by flush().
+         * @param element The element to remove.
+         */
+        void removeElement(T element);
+
+        /**
+         * @brief Wait until every logged mutation has been applied and published.
+         * @throws The first error raised by a logged operation since the last flush,
+         * e.g. std::runtime_error for the removal of a missing element.
+         */
+        void flush();
+
+        /**
+         * @brief Get the last published version of the container.
+         * @details The copy shares its storage with the published version, so this is O(1);
+         * it never changes, whatever is logged afterwards.
+         */
+        container_type snapshot() const;
+
+        /**
+         * @brief Get the number of elements of the last published version.
+         */
+        size_t size() const;
+
+        /**
+         * @brief Get the number of batches published so far.
+         */
+        std::uint64_t version() const { return publishedVersion.load(); }
+
+        /**
+         * @brief Get the number of logged mutations not taken by the maintenance thread yet.
+         */
+        size_t pending() const;
+    };
+
+    extern template class BasicBackgroundContainer<int>;
+    extern template class BasicBackgroundContainer<std::uint32_t>;
+    extern template class BasicBackgroundContainer<std::int64_t>;
+    extern template class BasicBackgroundContainer<std::uint64_t>;
+
+    /**
+     * @brief The background-maintained container of `int` elements.
+     */
+    using BackgroundContainer = BasicBackgroundContainer<int>;
+}
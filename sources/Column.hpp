@@ -0,0 +1,106 @@
+/**
+ * @file Column.hpp
+ * @brief An array that either owns its elements or borrows read-only memory.
+ * @details The element storage and the views of a MagicalContainer are columns, so a
+ * container loaded from a memory-mapped snapshot reads straight from the mapping.
+ * The first modification of a borrowed column copies it into an owned vector.
+ *
+ * @author Maya Rom
+ * @ID 207485251
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+#include <vector>
+
+namespace ariel
+{
+    /**
+     * @struct Footprint
+     * @brief Bytes used by an array and bytes it has allocated.
+     * @details Borrowed memory counts as used but not as allocated.
+     */
+    struct Footprint
+    {
+        size_t used = 0;
+        size_t capacity = 0;
+
+        Footprint &operator+=(const Footprint &other)
+        {
+            used += other.used;
+            capacity += other.capacity;
+            return *this;
+        }
+    };
+
+    /**
+     * @class Column
+     * @brief A read-mostly array of U, owned or borrowed.
+     */
+    template <typename U>
+    class Column
+    {
+        std::pmr::vector<U> owned;
+        const U *borrowedData = nullptr;
+        size_t borrowedSize = 0;
+        bool borrowed = false;
+
+    public:
+        explicit Column(std::pmr::memory_resource *resource = std::pmr::get_default_resource())
+            : owned(resource) {}
+
+        Column(const Column &other, std::pmr::memory_resource *resource)
+            : owned(other.data(), other.data() + other.size(), resource) {}
+
+        const U *data() const { return borrowed ? borrowedData : owned.data(); }
+        size_t size() const { return borrowed ? borrowedSize : owned.size(); }
+        bool empty() const { return size() == 0; }
+        U operator[](size_t pos) const { return data()[pos]; }
+        const U *begin() const { return data(); }
+        const U *end() const { return data() + size(); }
+
+        /**
+         * @brief Bytes of the elements, and bytes of the owned allocation.
+         */
+        Footprint footprint() const
+        {
+            return {size() * sizeof(U), borrowed ? 0 : owned.capacity() * sizeof(U)};
+        }
+
+        /**
+         * @brief Read from external memory that outlives the column.
+         */
+        void borrow(const U *source, size_t count)
+        {
+            owned.clear();
+            borrowedData = source;
+            borrowedSize = count;
+            borrowed = true;
+        }
+
+        /**
+         * @brief The elements as an owned vector, copying borrowed memory on first use.
+         */
+        std::pmr::vector<U> &own()
+        {
+            if (borrowed)
+            {
+                owned.assign(borrowedData, borrowedData + borrowedSize);
+                borrowed = false;
+            }
+            return owned;
+        }
+
+        /**
+         * @brief An owned, empty vector to refill, dropping borrowed memory without copying it.
+         */
+        std::pmr::vector<U> &fresh()
+        {
+            borrowed = false;
+            owned.clear();
+            return owned;
+        }
+    };
+}
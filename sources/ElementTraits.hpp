@@ -0,0 +1,280 @@
+/**
+ * @file ElementTraits.hpp
+ * @brief Compile-time element handling for MagicalContainer.
+ * @details ElementTraits<T> selects, per element type, the primality test, the radix
+ * sorting kernel used to build the ascending view and the integer width of view indices.
+ * All choices are made at compile time from the width and signedness of T.
+ *
+ * @author Maya Rom
+ * @ID 207485251
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <type_traits>
+#include <vector>
+
+namespace ariel
+{
+    namespace detail
+    {
+        /**
+         * @brief Compute (base ^ exp) mod mod without overflow, using Wide for the products.
+         */
+        template <typename Word, typename Wide>
+        Word powMod(Word base, Word exp, Word mod)
+        {
+            Word result = 1;
+            base %= mod;
+            while (exp != 0)
+            {
+                if ((exp & 1U) != 0)
+                {
+                    result = static_cast<Word>(static_cast<Wide>(result) * base % mod);
+                }
+                base = static_cast<Word>(static_cast<Wide>(base) * base % mod);
+                exp >>= 1U;
+            }
+            return result;
+        }
+
+        /**
+         * @brief Deterministic Miller-Rabin test for the given witness set.
+         * @details Small factors are trial-divided first, so most composites never reach
+         * the modular exponentiation.
+         */
+        template <typename Word, typename Wide, std::size_t N>
+        bool millerRabin(Word number, const std::array<Word, N> &bases)
+        {
+            static constexpr std::array<Word, 12> small = {2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37};
+            if (number < 2)
+                return false;
+            for (Word p : small)
+            {
+                if (number % p == 0)
+                    return number == p;
+            }
+            // every composite below 41 * 41 has a factor <= 37
+            if (number < 41 * 41)
+                return true;
+
+            Word odd = number - 1;
+            unsigned twos = 0;
+            while ((odd & 1U) == 0)
+            {
+                odd >>= 1U;
+                ++twos;
+            }
+
+            for (Word base : bases)
+            {
+                base %= number;
+                if (base == 0)
+                    continue;
+                Word x = powMod<Word, Wide>(base, odd, number);
+                if (x == 1 || x == number - 1)
+                    continue;
+                bool composite = true;
+                for (unsigned r = 1; r < twos && composite; ++r)
+                {
+                    x = static_cast<Word>(static_cast<Wide>(x) * x % number);
+                    composite = x != number - 1;
+                }
+                if (composite)
+                    return false;
+            }
+            return true;
+        }
+    }
+
+    /**
+     * @struct ElementTraits
+     * @brief Per-element-type configuration of MagicalContainer.
+     * @tparam T An integral element type (int, uint32_t, int64_t, uint64_t, ...).
+     */
+    template <typename T>
+    struct ElementTraits
+    {
+        static_assert(std::is_integral_v<T> && !std::is_same_v<T, bool>,
+                      "MagicalContainer elements must be integers");
+
+        using unsigned_type = std::make_unsigned_t<T>;
+
+        /**
+         * @brief Integer type stored in the views. 32 bits halves the view footprint compared
+         * to pointers, and caps a container at 2^32 - 1 elements; WideElementTraits lifts the cap.
+         */
+        using index_type = std::uint32_t;
+
+        /**
+         * @brief Integer type of sums of elements. Sums are added in the unsigned type of the
+         * same width, so sums beyond its range wrap modulo 2^64 instead of overflowing.
+         */
+        using sum_type = std::conditional_t<std::is_signed_v<T>, std::int64_t, std::uint64_t>;
+
+        /**
+         * @brief Number of 8-bit LSD radix passes needed to order T.
+         */
+        static constexpr unsigned radix_passes = sizeof(T);
+
+        /**
+         * @brief Map a value to an unsigned key with the same ordering.
+         */
+        static constexpr unsigned_type radixKey(T value)
+        {
+            if constexpr (std::is_signed_v<T>)
+            {
+                constexpr unsigned_type sign = unsigned_type(1) << (sizeof(T) * 8 - 1);
+                return static_cast<unsigned_type>(static_cast<unsigned_type>(value) ^ sign);
+            }
+            else
+            {
+                return value;
+            }
+        }
+
+        /**
+         * @brief Check if a number is prime.
+         * @details Values up to 32 bits use the {2, 7, 61} witnesses with 64-bit products,
+         * wider values use the seven 64-bit witnesses of Jim Sinclair with 128-bit products.
+         */
+        static bool isPrime(T number)
+        {
+            if constexpr (std::is_signed_v<T>)
+            {
+                if (number < 2)
+                    return false;
+            }
+            if constexpr (sizeof(T) <= sizeof(std::uint32_t))
+            {
+                static constexpr std::array<std::uint32_t, 3> bases = {2, 7, 61};
+                return detail::millerRabin<std::uint32_t, std::uint64_t>(static_cast<std::uint32_t>(number), bases);
+            }
+            else
+            {
+                static constexpr std::array<std::uint64_t, 7> bases = {2, 325, 9375, 28178, 450775, 9780504, 1795265022};
+                return detail::millerRabin<std::uint64_t, unsigned __int128>(static_cast<std::uint64_t>(number), bases);
+            }
+        }
+    };
+
+    /**
+     * @struct WideElementTraits
+     * @brief ElementTraits with 64-bit view indices, for containers of more than 2^32 - 1 elements.
+     */
+    template <typename T>
+    struct WideElementTraits : ElementTraits<T>
+    {
+        using index_type = std::uint64_t;
+    };
+
+    /**
+     * @struct CompactElementTraits
+     * @brief ElementTraits with 16-bit view indices, for many small containers of at most 2^16 - 1 elements.
+     */
+    template <typename T>
+    struct CompactElementTraits : ElementTraits<T>
+    {
+        using index_type = std::uint16_t;
+    };
+
+    /**
+     * @class RadixScratch
+     * @brief Reusable buffers for building an ascending index permutation.
+     * @details The buffers keep their capacity between rebuilds, so sorting the same
+     * container again does not allocate.
+     */
+    template <typename T, typename Index>
+    class RadixScratch
+    {
+        using Traits = ElementTraits<T>;
+        using Key = typename Traits::unsigned_type;
+
+        // below this size a comparison sort beats the histogram passes
+        static constexpr std::size_t small_size = 64;
+
+        std::pmr::vector<Key> keys;
+        std::pmr::vector<Key> keysAlt;
+        std::pmr::vector<Index> indicesAlt;
+
+    public:
+        explicit RadixScratch(std::pmr::memory_resource *resource = std::pmr::get_default_resource())
+            : keys(resource), keysAlt(resource), indicesAlt(resource) {}
+
+        /**
+         * @brief Bytes held by the buffers between rebuilds.
+         */
+        std::size_t capacityBytes() const
+        {
+            return (keys.capacity() + keysAlt.capacity()) * sizeof(Key) + indicesAlt.capacity() * sizeof(Index);
+        }
+
+        /**
+         * @brief Fill `out` with the indices of `values` in stable ascending order of value.
+         */
+        template <typename Alloc>
+        void sortIndices(const T *values, std::size_t count, std::vector<Index, Alloc> &out)
+        {
+            out.resize(count);
+            for (std::size_t i = 0; i < count; ++i)
+                out[i] = static_cast<Index>(i);
+
+            if (count < small_size)
+            {
+                std::stable_sort(out.begin(), out.end(), [values](Index a, Index b)
+                                 { return values[a] < values[b]; });
+                return;
+            }
+
+            keys.resize(count);
+            keysAlt.resize(count);
+            indicesAlt.resize(count);
+
+            std::array<std::array<std::size_t, 256>, Traits::radix_passes> histograms{};
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                Key key = Traits::radixKey(values[i]);
+                keys[i] = key;
+                for (unsigned pass = 0; pass < Traits::radix_passes; ++pass)
+                    ++histograms[pass][(key >> (pass * 8)) & 0xFFU];
+            }
+
+            Key *srcKeys = keys.data();
+            Key *dstKeys = keysAlt.data();
+            Index *srcIndices = out.data();
+            Index *dstIndices = indicesAlt.data();
+
+            for (unsigned pass = 0; pass < Traits::radix_passes; ++pass)
+            {
+                auto &histogram = histograms[pass];
+                // a digit shared by every key does not reorder anything
+                if (histogram[(srcKeys[0] >> (pass * 8)) & 0xFFU] == count)
+                    continue;
+
+                std::size_t offset = 0;
+                for (std::size_t &bucket : histogram)
+                {
+                    std::size_t bucketSize = bucket;
+                    bucket = offset;
+                    offset += bucketSize;
+                }
+                for (std::size_t i = 0; i < count; ++i)
+                {
+                    std::size_t slot = histogram[(srcKeys[i] >> (pass * 8)) & 0xFFU]++;
+                    dstKeys[slot] = srcKeys[i];
+                    dstIndices[slot] = srcIndices[i];
+                }
+                std::swap(srcKeys, dstKeys);
+                std::swap(srcIndices, dstIndices);
+            }
+
+            if (srcIndices != out.data())
+                std::copy(srcIndices, srcIndices + count, out.begin());
+        }
+    };
+}
@@ -0,0 +1,148 @@
+/**
+ * @file Fingerprint.hpp
+ * @brief Incrementally maintained content hashes of a MagicalContainer.
+ * @details The ordered hash is the polynomial sum of mix(v_i) * B^i modulo 2^64 over the
+ * elements in insertion order; the multiset hash is the plain sum of mix(v_i), which does
+ * not depend on the order. Appending updates both in O(1). Removing the element at index k
+ * shifts the later terms down one power, which is a multiplication by the inverse of B
+ * (B is odd, so it is invertible modulo 2^64) once the hash of the first k terms is known.
+ * Different hashes prove different contents; equal hashes only make equality likely.
+ *
+ * @author Maya Rom
+ * @ID 207485251
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace ariel
+{
+    /**
+     * @class Fingerprint
+     * @brief Insertion-order and order-independent hashes of a sequence of T.
+     */
+    template <typename T>
+    class Fingerprint
+    {
+        static constexpr std::uint64_t base = 0x9E3779B97F4A7C15ULL;
+
+        // Newton iteration for the inverse modulo 2^64, each step doubles the correct low bits
+        static constexpr std::uint64_t inverse(std::uint64_t odd)
+        {
+            std::uint64_t x = odd;
+            for (int step = 0; step < 5; ++step)
+                x *= 2 - odd * x;
+            return x;
+        }
+
+        static constexpr std::uint64_t baseInverse = inverse(base);
+        static_assert(base * baseInverse == 1, "the hash base must be invertible");
+
+        std::uint64_t orderedHash = 0;
+        std::uint64_t multisetHash = 0;
+        std::uint64_t power = 1; // B^size
+
+    public:
+        /**
+         * @brief The splitmix64 finalizer of a value, which spreads nearby values over the whole word.
+         */
+        static std::uint64_t mix(T value)
+        {
+            auto x = static_cast<std::uint64_t>(value);
+            x ^= x >> 30U;
+            x *= 0xBF58476D1CE4E5B9ULL;
+            x ^= x >> 27U;
+            x *= 0x94D049BB133111EBULL;
+            x ^= x >> 31U;
+            return x;
+        }
+
+        /**
+         * @brief The hash that depends on the order of the elements.
+         */
+        std::uint64_t ordered() const { return orderedHash; }
+
+        /**
+         * @brief The hash of the elements regardless of their order.
+         */
+        std::uint64_t multiset() const { return multisetHash; }
+
+        /**
+         * @brief Account for a value appended at the end.
+         */
+        void append(T value)
+        {
+            std::uint64_t mixed = mix(value);
+            orderedHash += mixed * power;
+            multisetHash += mixed;
+            power *= base;
+        }
+
+        /**
+         * @brief Account for `count` values appended at the end.
+         */
+        void append(const T *values, size_t count)
+        {
+            for (size_t i = 0; i < count; ++i)
+                append(values[i]);
+        }
+
+        /**
+         * @brief Account for the removal of values[index], in O(index).
+         * Called before the element is erased.
+         */
+        void erase(const T *values, size_t index)
+        {
+            std::uint64_t prefix = 0;
+            std::uint64_t at = 1;
+            for (size_t i = 0; i < index; ++i)
+            {
+                prefix += mix(values[i]) * at;
+                at *= base;
+            }
+            std::uint64_t mixed = mix(values[index]);
+            std::uint64_t suffix = orderedHash - prefix - mixed * at;
+            orderedHash = prefix + suffix * baseInverse;
+            multisetHash -= mixed;
+            power *= baseInverse;
+        }
+
+        /**
+         * @brief Account for the values hashed by other appended at the end, in O(1).
+         */
+        void concat(const Fingerprint &other)
+        {
+            orderedHash += other.orderedHash * power;
+            multisetHash += other.multisetHash;
+            power *= other.power;
+        }
+
+        /**
+         * @brief Hash `count` values from scratch.
+         */
+        static Fingerprint of(const T *values, size_t count)
+        {
+            Fingerprint result;
+            result.append(values, count);
+            return result;
+        }
+
+        /**
+         * @brief Restore a fingerprint saved with ordered() and multiset() for `count` values.
+         */
+        static Fingerprint restore(std::uint64_t ordered, std::uint64_t multiset, size_t count)
+        {
+            Fingerprint result;
+            result.orderedHash = ordered;
+            result.multisetHash = multiset;
+            for (std::uint64_t factor = base; count != 0; count >>= 1U, factor *= factor)
+            {
+                if ((count & 1U) != 0)
+                    result.power *= factor;
+            }
+            return result;
+        }
+    };
+}
@@ -0,0 +1,283 @@
+#include "FrozenContainer.hpp"
+#include <algorithm>
+#include <bit>
+
+using namespace ariel;
+using namespace std;
+
+namespace
+{
+    // Mask of the low `width` bits, for widths up to 64
+    std::uint64_t lowBits(unsigned width)
+    {
+        return width >= 64 ? ~std::uint64_t(0) : (std::uint64_t(1) << width) - 1;
+    }
+
+    // Read `width` bits starting at bit `offset`; the stream has a padding word at the end
+    std::uint64_t readBits(const std::uint64_t *words, std::uint64_t offset, unsigned width)
+    {
+        const std::uint64_t *word = words + (offset >> 6U);
+        auto shift = static_cast<unsigned>(offset & 63U);
+        std::uint64_t value = word[0] >> shift;
+        if (shift + width > 64)
+            value |= word[1] << (64 - shift);
+        return value & lowBits(width);
+    }
+
+    // Append `width` bits to the stream at bit `offset`
+    void writeBits(std::pmr::vector<std::uint64_t> &words, std::uint64_t offset, unsigned width, std::uint64_t value)
+    {
+        auto index = static_cast<size_t>(offset >> 6U);
+        auto shift = static_cast<unsigned>(offset & 63U);
+        words[index] |= value << shift;
+        if (shift + width > 64)
+            words[index + 1] |= value >> (64 - shift);
+    }
+}
+
+// Pack the ascending elements block by block
+template <typename T>
+BasicFrozenContainer<T>::BasicFrozenContainer(std::span<const T> ascending, std::span<const std::uint8_t> primeFlags,
+                                              std::pmr::memory_resource *resource)
+    : skips(resource), bits(resource), primes(resource), count(ascending.size())
+{
+    if (primeFlags.size() != ascending.size())
+        throw std::invalid_argument("Prime flags must match the elements");
+    if (!std::is_sorted(ascending.begin(), ascending.end()))
+        throw std::invalid_argument("Frozen elements must be in ascending order");
+
+    // size the stream first, so it is allocated once
+    size_t blocks = (count + block_size - 1) / block_size;
+    skips.reserve(blocks);
+    std::uint64_t totalBits = 0;
+    for (size_t first = 0; first < count; first += block_size)
+    {
+        size_t last = std::min(first + block_size, count);
+        unsigned_type widest = 0;
+        for (size_t i = first + 1; i < last; ++i)
+            widest = std::max(widest, static_cast<unsigned_type>(static_cast<unsigned_type>(ascending[i]) -
+                                                                 static_cast<unsigned_type>(ascending[i - 1])));
+        auto width = static_cast<std::uint8_t>(std::bit_width(widest));
+        skips.push_back({totalBits, ascending[first], width});
+        totalBits += static_cast<std::uint64_t>(width) * (last - first - 1);
+    }
+    bits.assign(static_cast<size_t>((totalBits + 63) / 64) + 1, 0);
+
+    for (size_t block = 0; block < blocks; ++block)
+    {
+        size_t first = block * block_size;
+        size_t last = std::min(first + block_size, count);
+        const Skip &skip = skips[block];
+        std::uint64_t offset = skip.bitOffset;
+        for (size_t i = first + 1; i < last; ++i, offset += skip.width)
+            writeBits(bits, offset, skip.width,
+                      static_cast<unsigned_type>(static_cast<unsigned_type>(ascending[i]) - static_cast<unsigned_type>(ascending[i - 1])));
+    }
+
+    primes.assign((count + 63) / 64, 0);
+    for (size_t rank = 0; rank < count; ++rank)
+    {
+        if (primeFlags[rank] != 0)
+            primes[rank / 64] |= std::uint64_t(1) << (rank % 64);
+    }
+}
+
+// Decode a block: unpack the deltas, then a prefix sum from the first value
+template <typename T>
+void BasicFrozenContainer<T>::decode(size_t index, Block &block) const
+{
+    const Skip &skip = skips[index];
+    size_t length = std::min(block_size, count - index * block_size);
+    std::array<unsigned_type, block_size> deltas;
+    const std::uint64_t *words = bits.data();
+    for (size_t i = 1; i < length; ++i)
+        deltas[i] = static_cast<unsigned_type>(readBits(words, skip.bitOffset + (i - 1) * skip.width, skip.width));
+
+    auto value = static_cast<unsigned_type>(skip.first);
+    block.values[0] = skip.first;
+    for (size_t i = 1; i < length; ++i)
+    {
+        value = static_cast<unsigned_type>(value + deltas[i]);
+        block.values[i] = static_cast<T>(value);
+    }
+    block.index = index;
+}
+
+// Rank of the next prime at or after rank
+template <typename T>
+size_t BasicFrozenContainer<T>::nextPrime(size_t rank) const
+{
+    if (rank >= count)
+        return count;
+    size_t word = rank / 64;
+    std::uint64_t pending = primes[word] & ~lowBits(static_cast<unsigned>(rank % 64));
+    while (pending == 0)
+    {
+        if (++word == primes.size())
+            return count;
+        pending = primes[word];
+    }
+    return word * 64 + static_cast<size_t>(std::countr_zero(pending));
+}
+
+// Memory of the skips, the stream and the bitmap
+template <typename T>
+Footprint BasicFrozenContainer<T>::footprint() const
+{
+    return {skips.size() * sizeof(Skip) + bits.size() * sizeof(std::uint64_t) + primes.size() * sizeof(std::uint64_t),
+            skips.capacity() * sizeof(Skip) + bits.capacity() * sizeof(std::uint64_t) + primes.capacity() * sizeof(std::uint64_t)};
+}
+
+// BasicIterator equality comparison operator
+template <typename T>
+bool BasicFrozenContainer<T>::BasicIterator::operator==(const BasicIterator &other) const
+{
+    if (container != other.container)
+        throw std::invalid_argument("Cant compare iterators from different containers");
+    return pos == other.pos;
+}
+
+// BasicIterator inequality comparison operator
+template <typename T>
+bool BasicFrozenContainer<T>::BasicIterator::operator!=(const BasicIterator &other) const
+{
+    return !(*this == other);
+}
+
+// BasicIterator greater than comparison operator
+template <typename T>
+bool BasicFrozenContainer<T>::BasicIterator::operator>(const BasicIterator &other) const
+{
+    if (container != other.container)
+        throw std::invalid_argument("Cant compare iterators from different containers");
+    return pos > other.pos;
+}
+
+// BasicIterator less than comparison operator
+template <typename T>
+bool BasicFrozenContainer<T>::BasicIterator::operator<(const BasicIterator &other) const
+{
+    if (container != other.container)
+        throw std::invalid_argument("Cant compare iterators from different containers");
+    return pos < other.pos;
+}
+
+// Dereference operator for AscendingIterator
+template <typename T>
+T BasicFrozenContainer<T>::AscendingIterator::operator*() const
+{
+    if (this->pos >= this->container->count)
+        throw std::runtime_error("Iterator is out of range");
+    return this->container->at(this->pos, block);
+}
+
+// Pre-increment operator for AscendingIterator
+template <typename T>
+typename BasicFrozenContainer<T>::AscendingIterator &BasicFrozenContainer<T>::AscendingIterator::operator++()
+{
+    if (this->pos >= this->container->count)
+        throw std::runtime_error("Iterator is out of range");
+    ++this->pos;
+    return *this;
+}
+
+// Begin function for AscendingIterator
+template <typename T>
+typename BasicFrozenContainer<T>::AscendingIterator BasicFrozenContainer<T>::AscendingIterator::begin() const
+{
+    return AscendingIterator(*this->container);
+}
+
+// End function for AscendingIterator
+template <typename T>
+typename BasicFrozenContainer<T>::AscendingIterator BasicFrozenContainer<T>::AscendingIterator::end() const
+{
+    AscendingIterator temp(*this->container);
+    temp.pos = this->container->count;
+    return temp;
+}
+
+// Dereference operator for SideCrossIterator, even steps read from the low end and odd steps from the high end
+template <typename T>
+T BasicFrozenContainer<T>::SideCrossIterator::operator*() const
+{
+    size_t count = this->container->count;
+    if (this->pos >= count)
+        throw std::runtime_error("Iterator is out of range");
+    if (this->pos % 2 == 0)
+        return this->container->at(this->pos / 2, low);
+    return this->container->at(count - 1 - this->pos / 2, high);
+}
+
+// Pre-increment operator for SideCrossIterator
+template <typename T>
+typename BasicFrozenContainer<T>::SideCrossIterator &BasicFrozenContainer<T>::SideCrossIterator::operator++()
+{
+    if (this->pos >= this->container->count)
+        throw std::runtime_error("Iterator is out of range");
+    ++this->pos;
+    return *this;
+}
+
+// Begin function for SideCrossIterator
+template <typename T>
+typename BasicFrozenContainer<T>::SideCrossIterator BasicFrozenContainer<T>::SideCrossIterator::begin() const
+{
+    return SideCrossIterator(*this->container);
+}
+
+// End function for SideCrossIterator
+template <typename T>
+typename BasicFrozenContainer<T>::SideCrossIterator BasicFrozenContainer<T>::SideCrossIterator::end() const
+{
+    SideCrossIterator temp(*this->container);
+    temp.pos = this->container->count;
+    return temp;
+}
+
+// PrimeIterator constructor, positioned at the smallest prime
+template <typename T>
+BasicFrozenContainer<T>::PrimeIterator::PrimeIterator(const BasicFrozenContainer &container)
+    : BasicIterator(container)
+{
+    this->pos = container.nextPrime(0);
+}
+
+// Dereference operator for PrimeIterator
+template <typename T>
+T BasicFrozenContainer<T>::PrimeIterator::operator*() const
+{
+    if (this->pos >= this->container->count)
+        throw std::runtime_error("Iterator is out of range");
+    return this->container->at(this->pos, block);
+}
+
+// Pre-increment operator for PrimeIterator
+template <typename T>
+typename BasicFrozenContainer<T>::PrimeIterator &BasicFrozenContainer<T>::PrimeIterator::operator++()
+{
+    if (this->pos >= this->container->count)
+        throw std::runtime_error("Iterator is out of range");
+    this->pos = this->container->nextPrime(this->pos + 1);
+    return *this;
+}
+
+// Begin function for PrimeIterator
+template <typename T>
+typename BasicFrozenContainer<T>::PrimeIterator BasicFrozenContainer<T>::PrimeIterator::begin() const
+{
+    return PrimeIterator(*this->container);
+}
+
+// End function for PrimeIterator
+template <typename T>
+typename BasicFrozenContainer<T>::PrimeIterator BasicFrozenContainer<T>::PrimeIterator::end() const
+{
+    return PrimeIterator(*this->container, this->container->count);
+}
+
+// The element types the container is compiled for
+template class ariel::BasicFrozenContainer<int>;
+template class ariel::BasicFrozenContainer<std::uint32_t>;
+template class ariel::BasicFrozenContainer<std::int64_t>;
+template class ariel::BasicFrozenContainer<std::uint64_t>;
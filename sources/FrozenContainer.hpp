@@ -0,0 +1,248 @@
+/**
+ * @file FrozenContainer.hpp
+ * @brief Defines an immutable, compressed snapshot of a MagicalContainer.
+ * @details BasicFrozenContainer stores the elements in ascending order, split into blocks of
+ * 128 values. Each block keeps its first value and the bit offset and width of its deltas in
+ * a skip entry; the deltas between consecutive values are bit-packed with the smallest width
+ * that holds the largest delta of the block. A bitmap over the ascending ranks marks the
+ * primes. Iterators decode one whole block into a small buffer at a time, with a branch-free
+ * unpacking loop followed by a prefix sum, and then read from the buffer.
+ * The insertion order is not kept, so the prime elements are visited in ascending order.
+ *
+ * @author Maya Rom
+ * @ID 207485251
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+#include "Column.hpp"
+#include "ElementTraits.hpp"
+
+namespace ariel
+{
+    /**
+     * @class BasicFrozenContainer
+     * @brief Delta-encoded, bit-packed ascending elements with a primality bitmap.
+     * @tparam T The integer element type.
+     */
+    template <typename T>
+    class BasicFrozenContainer
+    {
+    public:
+        using value_type = T;
+        using traits_type = ElementTraits<T>;
+
+        /**
+         * @brief Number of values per packed block.
+         */
+        static constexpr size_t block_size = 128;
+
+    private:
+        using unsigned_type = typename traits_type::unsigned_type;
+
+        /**
+         * @brief Where a block starts: its first value and its deltas in the bit stream.
+         */
+        struct Skip
+        {
+            std::uint64_t bitOffset;
+            T first;
+            std::uint8_t width;
+        };
+
+        /**
+         * @brief A decoded block, cached by an iterator.
+         */
+        struct Block
+        {
+            std::array<T, block_size> values;
+            size_t index = SIZE_MAX;
+        };
+
+        std::pmr::vector<Skip> skips;
+        std::pmr::vector<std::uint64_t> bits;   // the packed deltas, plus one word of padding
+        std::pmr::vector<std::uint64_t> primes; // bit r is set when the element of rank r is prime
+        size_t count = 0;
+
+        /**
+         * @brief Decode block `index` into `block`.
+         */
+        void decode(size_t index, Block &block) const;
+
+        /**
+         * @brief Get the element of the given ascending rank through a block cache.
+         */
+        T at(size_t rank, Block &block) const
+        {
+            if (block.index != rank / block_size)
+                decode(rank / block_size, block);
+            return block.values[rank % block_size];
+        }
+
+        /**
+         * @brief Get the rank of the first prime at or after `rank`, or size() if there is none.
+         */
+        size_t nextPrime(size_t rank) const;
+
+        /**
+         * @class BasicIterator
+         * @brief Base class for the iterator classes of FrozenContainer.
+         */
+        class BasicIterator
+        {
+        protected:
+            const BasicFrozenContainer *container;
+            size_t pos;
+
+        public:
+            BasicIterator(const BasicFrozenContainer &container) : container(&container), pos(0) {}
+
+            /**
+             * @brief Equality operator for BasicIterator.
+             * @throws std::invalid_argument if the iterators belong to different containers.
+             */
+            bool operator==(const BasicIterator &other) const;
+
+            /**
+             * @brief Inequality operator for BasicIterator.
+             * @throws std::invalid_argument if the iterators belong to different containers.
+             */
+            bool operator!=(const BasicIterator &other) const;
+
+            /**
+             * @brief Greater than operator for BasicIterator.
+             * @throws std::invalid_argument if the iterators belong to different containers.
+             */
+            bool operator>(const BasicIterator &other) const;
+
+            /**
+             * @brief Less than operator for BasicIterator.
+             * @throws std::invalid_argument if the iterators belong to different containers.
+             */
+            bool operator<(const BasicIterator &other) const;
+        };
+
+    public:
+        /**
+         * @brief Compress elements given in ascending order.
+         * @param ascending The elements, sorted in ascending order.
+         * @param primeFlags Non-zero at the ranks of the prime elements; same size as ascending.
+         * @param resource The memory resource to allocate from (must outlive the container).
+         * @throws std::invalid_argument if the elements are not sorted or the sizes differ.
+         */
+        BasicFrozenContainer(std::span<const T> ascending, std::span<const std::uint8_t> primeFlags,
+                             std::pmr::memory_resource *resource = std::pmr::get_default_resource());
+
+        /**
+         * @brief Get the number of elements.
+         */
+        size_t size() const { return count; }
+
+        /**
+         * @brief Get the bytes used and allocated by the skip entries, the packed deltas and the bitmap.
+         */
+        Footprint footprint() const;
+
+        /**
+         * @class AscendingIterator
+         * @brief The elements in ascending order, decoding a block at a time.
+         */
+        class AscendingIterator : public BasicIterator
+        {
+            mutable Block block;
+
+        public:
+            AscendingIterator(const BasicFrozenContainer &container) : BasicIterator(container) {}
+
+            /**
+             * @brief Dereference operator for AscendingIterator.
+             * @throws std::runtime_error if the iterator is at the end.
+             */
+            T operator*() const;
+
+            /**
+             * @brief Pre-increment operator for AscendingIterator.
+             * @throws std::runtime_error if the iterator is at the end.
+             */
+            AscendingIterator &operator++();
+
+            AscendingIterator begin() const;
+            AscendingIterator end() const;
+        };
+
+        /**
+         * @class SideCrossIterator
+         * @brief The elements alternating from the smallest and the largest end, one cached block per end.
+         */
+        class SideCrossIterator : public BasicIterator
+        {
+            mutable Block low;
+            mutable Block high;
+
+        public:
+            SideCrossIterator(const BasicFrozenContainer &container) : BasicIterator(container) {}
+
+            /**
+             * @brief Dereference operator for SideCrossIterator.
+             * @throws std::runtime_error if the iterator is at the end.
+             */
+            T operator*() const;
+
+            /**
+             * @brief Pre-increment operator for SideCrossIterator.
+             * @throws std::runtime_error if the iterator is at the end.
+             */
+            SideCrossIterator &operator++();
+
+            SideCrossIterator begin() const;
+            SideCrossIterator end() const;
+        };
+
+        /**
+         * @class PrimeIterator
+         * @brief The prime elements in ascending order, found in the primality bitmap.
+         */
+        class PrimeIterator : public BasicIterator
+        {
+            mutable Block block;
+
+            PrimeIterator(const BasicFrozenContainer &container, size_t pos) : BasicIterator(container) { this->pos = pos; }
+
+        public:
+            PrimeIterator(const BasicFrozenContainer &container);
+
+            /**
+             * @brief Dereference operator for PrimeIterator.
+             * @throws std::runtime_error if the iterator is at the end.
+             */
+            T operator*() const;
+
+            /**
+             * @brief Pre-increment operator for PrimeIterator.
+             * @throws std::runtime_error if the iterator is at the end.
+             */
+            PrimeIterator &operator++();
+
+            PrimeIterator begin() const;
+            PrimeIterator end() const;
+        };
+    };
+
+    extern template class BasicFrozenContainer<int>;
+    extern template class BasicFrozenContainer<std::uint32_t>;
+    extern template class BasicFrozenContainer<std::int64_t>;
+    extern template class BasicFrozenContainer<std::uint64_t>;
+
+    /**
+     * @brief The frozen container of `int` elements.
+     */
+    using FrozenContainer = BasicFrozenContainer<int>;
+}
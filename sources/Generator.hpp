@@ -0,0 +1,132 @@
+/**
+ * @file Generator.hpp
+ * @brief A lazy, coroutine-based sequence of values, in the style of C++23 std::generator.
+ * @details A Generator runs its coroutine only as far as it is read: each increment resumes
+ * the coroutine up to its next co_yield. A Generator is an input view, so it composes with
+ * the std::views adaptors, e.g. `container.ascendingFrom(x) | std::views::filter(IsPrime()) |
+ * std::views::take(10)` stops scanning once ten values have been read.
+ *
+ * @author Maya Rom
+ * @ID 207485251
+ */
+
+#pragma once
+
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <iterator>
+#include <ranges>
+#include <utility>
+
+namespace ariel
+{
+    /**
+     * @class Generator
+     * @brief A move-only input range of values produced by a coroutine.
+     * @tparam T The type of the values.
+     */
+    template <typename T>
+    class Generator : public std::ranges::view_base
+    {
+    public:
+        struct promise_type
+        {
+            const T *current = nullptr;
+            std::exception_ptr failure;
+
+            Generator get_return_object() { return Generator(std::coroutine_handle<promise_type>::from_promise(*this)); }
+            std::suspend_always initial_suspend() noexcept { return {}; }
+            std::suspend_always final_suspend() noexcept { return {}; }
+            std::suspend_always yield_value(const T &value) noexcept
+            {
+                current = std::addressof(value);
+                return {};
+            }
+            void return_void() noexcept {}
+            void unhandled_exception() { failure = std::current_exception(); }
+
+            // co_await is not meaningful in a generator
+            template <typename U>
+            std::suspend_never await_transform(U &&) = delete;
+        };
+
+    private:
+        std::coroutine_handle<promise_type> coroutine;
+
+        explicit Generator(std::coroutine_handle<promise_type> coroutine) : coroutine(coroutine) {}
+
+        // Run the coroutine to its next value, rethrowing what it threw
+        static void resume(std::coroutine_handle<promise_type> coroutine)
+        {
+            coroutine.resume();
+            if (coroutine.promise().failure)
+                std::rethrow_exception(std::exchange(coroutine.promise().failure, nullptr));
+        }
+
+    public:
+        /**
+         * @class Iterator
+         * @brief Reads the values of a Generator; only one pass is possible.
+         */
+        class Iterator
+        {
+            std::coroutine_handle<promise_type> coroutine;
+
+        public:
+            using value_type = T;
+            using difference_type = std::ptrdiff_t;
+
+            Iterator() = default;
+            explicit Iterator(std::coroutine_handle<promise_type> coroutine) : coroutine(coroutine) {}
+
+            const T &operator*() const { return *coroutine.promise().current; }
+
+            /**
+             * @brief Resume the coroutine up to its next value.
+             * @throws Whatever the coroutine throws.
+             */
+            Iterator &operator++()
+            {
+                resume(coroutine);
+                return *this;
+            }
+            void operator++(int) { ++*this; }
+
+            bool operator==(std::default_sentinel_t) const { return !coroutine || coroutine.done(); }
+        };
+
+        Generator() = default;
+        Generator(const Generator &) = delete;
+        Generator &operator=(const Generator &) = delete;
+        Generator(Generator &&other) noexcept : coroutine(std::exchange(other.coroutine, {})) {}
+        Generator &operator=(Generator &&other) noexcept
+        {
+            if (this != &other)
+            {
+                if (coroutine)
+                    coroutine.destroy();
+                coroutine = std::exchange(other.coroutine, {});
+            }
+            return *this;
+        }
+        ~Generator()
+        {
+            if (coroutine)
+                coroutine.destroy();
+        }
+
+        /**
+         * @brief Start the coroutine and get an iterator at its first value.
+         * @throws Whatever the coroutine throws before its first value.
+         */
+        Iterator begin()
+        {
+            if (coroutine)
+                resume(coroutine);
+            return Iterator(coroutine);
+        }
+
+        std::default_sentinel_t end() const { return std::default_sentinel; }
+    };
+}
@@ -0,0 +1,270 @@
+#include "HashShardedContainer.hpp"
+#include "Fingerprint.hpp"
+
+using namespace ariel;
+using namespace std;
+
+// One shard each, all empty
+template <typename T>
+BasicHashShardedContainer<T>::BasicHashShardedContainer(size_t shards, std::pmr::memory_resource *resource)
+{
+    if (shards == 0)
+        throw std::invalid_argument("A sharded container needs at least one shard");
+    shardList.reserve(shards);
+    for (size_t i = 0; i < shards; ++i)
+        shardList.push_back(std::make_unique<Shard>(resource));
+}
+
+// Shard picked by the mixed bits of the value
+template <typename T>
+size_t BasicHashShardedContainer<T>::shardOf(T value) const
+{
+    return static_cast<size_t>(Fingerprint<T>::mix(value) % shardList.size());
+}
+
+// Add to one shard under its lock
+template <typename T>
+void BasicHashShardedContainer<T>::addElement(T element)
+{
+    Shard &target = *shardList[shardOf(element)];
+    std::lock_guard<std::mutex> lock(target.mutex);
+    target.container.addElement(element);
+}
+
+// Partition by shard, then one bulk insert per shard
+template <typename T>
+void BasicHashShardedContainer<T>::addElements(std::span<const T> elements)
+{
+    std::vector<std::vector<T>> parts(shardList.size());
+    for (T element : elements)
+        parts[shardOf(element)].push_back(element);
+    for (size_t i = 0; i < parts.size(); ++i)
+    {
+        if (parts[i].empty())
+            continue;
+        std::lock_guard<std::mutex> lock(shardList[i]->mutex);
+        shardList[i]->container.addElements(parts[i]);
+    }
+}
+
+// Remove from one shard under its lock
+template <typename T>
+void BasicHashShardedContainer<T>::removeElement(T element)
+{
+    Shard &target = *shardList[shardOf(element)];
+    std::lock_guard<std::mutex> lock(target.mutex);
+    target.container.removeElement(element);
+}
+
+// Total size over the shards
+template <typename T>
+size_t BasicHashShardedContainer<T>::size() const
+{
+    size_t total = 0;
+    for (const auto &entry : shardList)
+    {
+        std::lock_guard<std::mutex> lock(entry->mutex);
+        total += entry->container.size();
+    }
+    return total;
+}
+
+// Direct access to a shard
+template <typename T>
+typename BasicHashShardedContainer<T>::container_type &BasicHashShardedContainer<T>::shard(size_t index)
+{
+    if (index >= shardList.size())
+        throw std::out_of_range("No such shard");
+    return shardList[index]->container;
+}
+
+// Build the loser tree: every node starts with the sentinel, then each leaf is played in
+template <typename T>
+BasicHashShardedContainer<T>::Merge::Merge(const BasicHashShardedContainer &container, bool descending)
+    : container(&container), descending(descending)
+{
+    size_t leaves = container.shardList.size();
+    consumed.assign(leaves, 0);
+    sizes.resize(leaves);
+    heads.resize(leaves);
+    tree.assign(leaves, leaves);
+    for (size_t leaf = 0; leaf < leaves; ++leaf)
+    {
+        sizes[leaf] = container.shardList[leaf]->container.size();
+        load(leaf);
+    }
+    for (size_t leaf = leaves; leaf-- > 0;)
+        replay(leaf);
+}
+
+// Read the next element of a shard from this end
+template <typename T>
+void BasicHashShardedContainer<T>::Merge::load(size_t leaf)
+{
+    if (exhausted(leaf))
+        return;
+    size_t rank = descending ? sizes[leaf] - 1 - consumed[leaf] : consumed[leaf];
+    heads[leaf] = container->shardList[leaf]->container.kthSmallest(rank);
+}
+
+// Order of two leaves, exhausted leaves last and ties by shard index
+template <typename T>
+bool BasicHashShardedContainer<T>::Merge::beats(size_t a, size_t b) const
+{
+    size_t sentinel = tree.size();
+    if (a == sentinel || b == sentinel)
+        return a == sentinel;
+    if (exhausted(a) || exhausted(b))
+        return !exhausted(a);
+    if (heads[a] != heads[b])
+        return descending ? heads[b] < heads[a] : heads[a] < heads[b];
+    return descending ? b < a : a < b;
+}
+
+// Walk from the leaf to the root, leaving the loser at every node
+template <typename T>
+void BasicHashShardedContainer<T>::Merge::replay(size_t leaf)
+{
+    size_t winner = leaf;
+    for (size_t node = (leaf + tree.size()) / 2; node > 0; node /= 2)
+    {
+        if (beats(tree[node], winner))
+            std::swap(tree[node], winner);
+    }
+    tree[0] = winner;
+}
+
+// Move past the winner and replay its path
+template <typename T>
+void BasicHashShardedContainer<T>::Merge::pop()
+{
+    size_t leaf = tree[0];
+    ++consumed[leaf];
+    load(leaf);
+    replay(leaf);
+}
+
+// BasicIterator equality comparison operator
+template <typename T>
+bool BasicHashShardedContainer<T>::BasicIterator::operator==(const BasicIterator &other) const
+{
+    if (container != other.container)
+        throw std::invalid_argument("Cant compare iterators from different containers");
+    return pos == other.pos;
+}
+
+// BasicIterator inequality comparison operator
+template <typename T>
+bool BasicHashShardedContainer<T>::BasicIterator::operator!=(const BasicIterator &other) const
+{
+    return !(*this == other);
+}
+
+// BasicIterator greater than comparison operator
+template <typename T>
+bool BasicHashShardedContainer<T>::BasicIterator::operator>(const BasicIterator &other) const
+{
+    if (container != other.container)
+        throw std::invalid_argument("Cant compare iterators from different containers");
+    return pos > other.pos;
+}
+
+// BasicIterator less than comparison operator
+template <typename T>
+bool BasicHashShardedContainer<T>::BasicIterator::operator<(const BasicIterator &other) const
+{
+    if (container != other.container)
+        throw std::invalid_argument("Cant compare iterators from different containers");
+    return pos < other.pos;
+}
+
+// AscendingIterator constructor, at the smallest element
+template <typename T>
+BasicHashShardedContainer<T>::AscendingIterator::AscendingIterator(BasicHashShardedContainer &container)
+    : BasicIterator(container), merge(container, false) {}
+
+// Dereference operator for AscendingIterator
+template <typename T>
+T BasicHashShardedContainer<T>::AscendingIterator::operator*() const
+{
+    if (this->pos >= this->total)
+        throw std::runtime_error("Iterator is out of range");
+    return merge.head();
+}
+
+// Pre-increment operator for AscendingIterator
+template <typename T>
+typename BasicHashShardedContainer<T>::AscendingIterator &BasicHashShardedContainer<T>::AscendingIterator::operator++()
+{
+    if (this->pos >= this->total)
+        throw std::runtime_error("Iterator is out of range");
+    merge.pop();
+    ++this->pos;
+    return *this;
+}
+
+// Begin function for AscendingIterator
+template <typename T>
+typename BasicHashShardedContainer<T>::AscendingIterator BasicHashShardedContainer<T>::AscendingIterator::begin() const
+{
+    return AscendingIterator(*this->container);
+}
+
+// End function for AscendingIterator, only its position matters
+template <typename T>
+typename BasicHashShardedContainer<T>::AscendingIterator BasicHashShardedContainer<T>::AscendingIterator::end() const
+{
+    AscendingIterator temp(*this);
+    temp.pos = temp.total;
+    return temp;
+}
+
+// SideCrossIterator constructor, one merge from each end
+template <typename T>
+BasicHashShardedContainer<T>::SideCrossIterator::SideCrossIterator(BasicHashShardedContainer &container)
+    : BasicIterator(container), low(container, false), high(container, true) {}
+
+// Dereference operator for SideCrossIterator, even steps read the low end and odd steps the high end
+template <typename T>
+T BasicHashShardedContainer<T>::SideCrossIterator::operator*() const
+{
+    if (this->pos >= this->total)
+        throw std::runtime_error("Iterator is out of range");
+    return this->pos % 2 == 0 ? low.head() : high.head();
+}
+
+// Pre-increment operator for SideCrossIterator
+template <typename T>
+typename BasicHashShardedContainer<T>::SideCrossIterator &BasicHashShardedContainer<T>::SideCrossIterator::operator++()
+{
+    if (this->pos >= this->total)
+        throw std::runtime_error("Iterator is out of range");
+    if (this->pos % 2 == 0)
+        low.pop();
+    else
+        high.pop();
+    ++this->pos;
+    return *this;
+}
+
+// Begin function for SideCrossIterator
+template <typename T>
+typename BasicHashShardedContainer<T>::SideCrossIterator BasicHashShardedContainer<T>::SideCrossIterator::begin() const
+{
+    return SideCrossIterator(*this->container);
+}
+
+// End function for SideCrossIterator, only its position matters
+template <typename T>
+typename BasicHashShardedContainer<T>::SideCrossIterator BasicHashShardedContainer<T>::SideCrossIterator::end() const
+{
+    SideCrossIterator temp(*this);
+    temp.pos = temp.total;
+    return temp;
+}
+
+// The element types the container is compiled for
+template class ariel::BasicHashShardedContainer<int>;
+template class ariel::BasicHashShardedContainer<std::uint32_t>;
+template class ariel::BasicHashShardedContainer<std::int64_t>;
+template class ariel::BasicHashShardedContainer<std::uint64_t>;
@@ -0,0 +1,259 @@
+/**
+ * @file HashShardedContainer.hpp
+ * @brief Defines a MagicalContainer split into shards by a hash of the values.
+ * @details BasicHashShardedContainer sends every value to the shard picked by its hash, so
+ * the writes spread over the shards even when the values crowd into a narrow range, where
+ * range sharding would send them all to one shard. Each shard is an independent
+ * MagicalContainer with its own lock. The shards are not ordered relative to each other, so
+ * the ascending iterator merges their ascending views with a loser tree: the tree keeps the
+ * loser of every match between the heads of the shards, and moving past the winner replays
+ * only the matches on its path, in O(log K) comparisons for K shards. The side-cross
+ * iterator runs one such merge from the smallest end and one from the largest end.
+ * All the copies of one value hash to the same shard.
+ *
+ * @author Maya Rom
+ * @ID 207485251
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+#include "MagicalContainer.hpp"
+
+namespace ariel
+{
+    /**
+     * @class BasicHashShardedContainer
+     * @brief K MagicalContainer shards picked by the hash of the values.
+     * @tparam T The integer element type.
+     */
+    template <typename T>
+    class BasicHashShardedContainer
+    {
+    public:
+        using value_type = T;
+        using container_type = BasicMagicalContainer<T>;
+
+    private:
+        /**
+         * @brief One shard and the lock of its writers, on its own cache lines.
+         */
+        struct alignas(64) Shard
+        {
+            std::mutex mutex;
+            container_type container;
+
+            explicit Shard(std::pmr::memory_resource *resource) : container(resource) {}
+        };
+
+        std::vector<std::unique_ptr<Shard>> shardList;
+
+        /**
+         * @class Merge
+         * @brief A loser tree over the ascending views of the shards, read from one end.
+         * @details Leaf i is the next unread element of shard i. tree[0] holds the leaf of the
+         * winner, and tree[1..K-1] the loser of the match played at that node. Equal values are
+         * ordered by shard index, so the descending merge is the exact reverse of the ascending one.
+         */
+        class Merge
+        {
+            const BasicHashShardedContainer *container = nullptr;
+            bool descending = false;
+            std::vector<size_t> consumed; // elements of each shard already read from this end
+            std::vector<size_t> sizes;
+            std::vector<T> heads;
+            std::vector<size_t> tree;
+
+            bool exhausted(size_t leaf) const { return consumed[leaf] == sizes[leaf]; }
+
+            /**
+             * @brief Check whether leaf a comes before leaf b; leaf K stands for a sentinel that beats every leaf.
+             */
+            bool beats(size_t a, size_t b) const;
+
+            void load(size_t leaf);
+
+            /**
+             * @brief Replay the matches from a leaf up to the root.
+             */
+            void replay(size_t leaf);
+
+        public:
+            Merge() = default;
+            Merge(const BasicHashShardedContainer &container, bool descending);
+
+            /**
+             * @brief Get the element at the head of the merge; the merge must not be exhausted.
+             */
+            T head() const { return heads[tree[0]]; }
+
+            /**
+             * @brief Move past the head, in O(log K).
+             */
+            void pop();
+        };
+
+        /**
+         * @class BasicIterator
+         * @brief Base class for the iterator classes of HashShardedContainer.
+         */
+        class BasicIterator
+        {
+        protected:
+            BasicHashShardedContainer *container;
+            size_t pos;
+            size_t total; // the number of elements when the iterator was made
+
+        public:
+            BasicIterator(BasicHashShardedContainer &container) : container(&container), pos(0), total(container.size()) {}
+
+            /**
+             * @brief Equality operator for BasicIterator.
+             * @throws std::invalid_argument if the iterators belong to different containers.
+             */
+            bool operator==(const BasicIterator &other) const;
+
+            /**
+             * @brief Inequality operator for BasicIterator.
+             * @throws std::invalid_argument if the iterators belong to different containers.
+             */
+            bool operator!=(const BasicIterator &other) const;
+
+            /**
+             * @brief Greater than operator for BasicIterator.
+             * @throws std::invalid_argument if the iterators belong to different containers.
+             */
+            bool operator>(const BasicIterator &other) const;
+
+            /**
+             * @brief Less than operator for BasicIterator.
+             * @throws std::invalid_argument if the iterators belong to different containers.
+             */
+            bool operator<(const BasicIterator &other) const;
+        };
+
+    public:
+        /**
+         * @brief Constructs an empty container.
+         * @param shards The number of shards.
+         * @param resource The memory resource of the shards (must outlive the container).
+         * @throws std::invalid_argument if shards is 0.
+         */
+        explicit BasicHashShardedContainer(size_t shards, std::pmr::memory_resource *resource = std::pmr::get_default_resource());
+
+        /**
+         * @brief Add an element to its shard, locking only that shard.
+         * @param element The element to add.
+         */
+        void addElement(T element);
+
+        /**
+         * @brief Add many elements, one bulk insert per shard.
+         * @param elements The elements to add.
+         */
+        void addElements(std::span<const T> elements);
+
+        /**
+         * @brief Remove an element from its shard, locking only that shard.
+         * @param element The element to remove.
+         * @throws std::runtime_error if the element is not in the container.
+         */
+        void removeElement(T element);
+
+        /**
+         * @brief Get the number of elements in all the shards.
+         */
+        size_t size() const;
+
+        /**
+         * @brief Get the number of shards.
+         */
+        size_t shards() const { return shardList.size(); }
+
+        /**
+         * @brief Get the index of the shard that holds a value.
+         */
+        size_t shardOf(T value) const;
+
+        /**
+         * @brief Get a shard.
+         * @note Access through this reference is not locked.
+         */
+        container_type &shard(size_t index);
+
+        /**
+         * @class AscendingIterator
+         * @brief The elements in ascending order, merging the shards through a loser tree.
+         * @note The shards must not be modified while the iterator is used.
+         */
+        class AscendingIterator : public BasicIterator
+        {
+            Merge merge;
+
+        public:
+            AscendingIterator(BasicHashShardedContainer &container);
+
+            /**
+             * @brief Dereference operator for AscendingIterator.
+             * @throws std::runtime_error if the iterator is at the end.
+             */
+            T operator*() const;
+
+            /**
+             * @brief Pre-increment operator for AscendingIterator, in O(log K).
+             * @throws std::runtime_error if the iterator is at the end.
+             */
+            AscendingIterator &operator++();
+
+            AscendingIterator begin() const;
+            AscendingIterator end() const;
+        };
+
+        /**
+         * @class SideCrossIterator
+         * @brief The merged ascending order read alternately from its smallest and largest end.
+         * @note The shards must not be modified while the iterator is used.
+         */
+        class SideCrossIterator : public BasicIterator
+        {
+            Merge low;
+            Merge high;
+
+        public:
+            SideCrossIterator(BasicHashShardedContainer &container);
+
+            /**
+             * @brief Dereference operator for SideCrossIterator.
+             * @throws std::runtime_error if the iterator is at the end.
+             */
+            T operator*() const;
+
+            /**
+             * @brief Pre-increment operator for SideCrossIterator, in O(log K).
+             * @throws std::runtime_error if the iterator is at the end.
+             */
+            SideCrossIterator &operator++();
+
+            SideCrossIterator begin() const;
+            SideCrossIterator end() const;
+        };
+    };
+
+    extern template class BasicHashShardedContainer<int>;
+    extern template class BasicHashShardedContainer<std::uint32_t>;
+    extern template class BasicHashShardedContainer<std::int64_t>;
+    extern template class BasicHashShardedContainer<std::uint64_t>;
+
+    /**
+     * @brief The hash-sharded container of `int` elements.
+     */
+    using HashShardedContainer = BasicHashShardedContainer<int>;
+}
@@ -1,106 +1,299 @@
 #include "MagicalContainer.hpp"
-#include <math.h>
+#include "FrozenContainer.hpp"
 #include <iostream>
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <istream>
+#include <limits>
+#include <memory>
+#include <ranges>
+#include <stdexcept>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 using namespace ariel;
 using namespace std;
 
+// Instrumentation is compiled in with -DMAGICAL_CONTAINER_STATS, MAGICAL_STATS(...) expands to nothing otherwise
+#ifdef MAGICAL_CONTAINER_STATS
+#define MAGICAL_STATS(statement) statement
+#else
+#define MAGICAL_STATS(statement)
+#endif
+
+namespace
+{
+    // Snapshot file layout: this header, then the element array and the ascending,
+    // cross and prime index arrays, each starting at a 64-byte aligned offset.
+    struct SnapshotHeader
+    {
+        std::array<char, 8> magic;
+        std::uint32_t version;
+        std::uint32_t byteOrder;
+        std::uint32_t elementSize;
+        std::uint32_t elementSigned;
+        std::uint32_t indexSize;
+        std::uint32_t reserved;
+        std::uint64_t count;
+        std::uint64_t primeCount;
+        std::uint64_t regularOffset;
+        std::uint64_t sortOffset;
+        std::uint64_t crossOffset;
+        std::uint64_t primeOffset;
+        std::uint64_t orderedHash;
+        std::uint64_t multisetHash;
+    };
+
+    constexpr std::array<char, 8> snapshotMagic = {'M', 'A', 'G', 'I', 'C', 'A', 'L', '\0'};
+    constexpr std::uint32_t snapshotVersion = 2;
+    constexpr std::uint32_t snapshotByteOrder = 0x01020304;
+    constexpr std::uint64_t snapshotAlignment = 64;
+
+    std::uint64_t alignSnapshotOffset(std::uint64_t offset)
+    {
+        return (offset + snapshotAlignment - 1) / snapshotAlignment * snapshotAlignment;
+    }
+
+    // Write an array at `offset`, padding from the current end of the file
+    template <typename U>
+    void writeSnapshotArray(std::ofstream &out, std::uint64_t offset, const U *values, size_t count)
+    {
+        static constexpr std::array<char, snapshotAlignment> padding{};
+        auto current = static_cast<std::uint64_t>(out.tellp());
+        out.write(padding.data(), static_cast<std::streamsize>(offset - current));
+        out.write(reinterpret_cast<const char *>(values), static_cast<std::streamsize>(count * sizeof(U)));
+    }
+
+    // Adds the nanoseconds of its lifetime to a counter
+    class StatsTimer
+    {
+        std::uint64_t &target;
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    public:
+        explicit StatsTimer(std::uint64_t &target) : target(target) {}
+        StatsTimer(const StatsTimer &) = delete;
+        StatsTimer &operator=(const StatsTimer &) = delete;
+
+        ~StatsTimer()
+        {
+            auto elapsed = std::chrono::steady_clock::now() - start;
+            target += static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+        }
+    };
+
+    // Size of the chunks read from a stream by ingest()
+    constexpr size_t ingestChunkSize = size_t(1) << 20;
+
+    bool isIngestSeparator(char character)
+    {
+        return character == ',' || character == ' ' || character == '\n' || character == '\r' || character == '\t';
+    }
+
+    // Parse the integers of [begin, end) onto `out`. Unless `final` is set, a token that
+    // touches `end` may continue in the next chunk, so it is left unparsed.
+    // Returns where parsing stopped.
+    template <typename T>
+    const char *parseIntegers(const char *begin, const char *end, bool final, std::pmr::vector<T> &out)
+    {
+        const char *cursor = begin;
+        while (true)
+        {
+            while (cursor != end && isIngestSeparator(*cursor))
+                ++cursor;
+            if (cursor == end)
+                return cursor;
+
+            // a token that reaches the end may continue in the next chunk, even a bare sign
+            const char *tokenEnd = std::find_if(cursor, end, isIngestSeparator);
+            if (tokenEnd == end && !final)
+                return cursor;
+
+            T value{};
+            auto [stop, error] = std::from_chars(cursor, tokenEnd, value);
+            if (error != std::errc() || stop != tokenEnd)
+                throw std::runtime_error("Malformed integer in input: " + std::string(cursor, tokenEnd));
+            out.push_back(value);
+            cursor = stop;
+        }
+    }
+
+    // Check that an array of the header lies inside the mapped file
+    bool snapshotArrayFits(std::uint64_t offset, std::uint64_t count, std::uint64_t width, std::uint64_t fileSize)
+    {
+        return offset % snapshotAlignment == 0 && offset <= fileSize && count <= (fileSize - offset) / width;
+    }
+}
+
 // Check if a number is prime
-bool MagicalContainer::isPrime(int num) const
+template <typename T, typename Traits>
+bool BasicMagicalContainer<T, Traits>::isPrime(T num) const
 {
-    if (num <= 1)
-        return false;
-    for (int i = 2; i <= sqrt(num); i++)
+    return traits_type::isPrime(num);
+}
+
+// Storage constructor
+template <typename T, typename Traits>
+BasicMagicalContainer<T, Traits>::Storage::Storage(std::pmr::memory_resource *resource)
+    : regular(resource),
+      cross(resource),
+      sort(resource),
+      prime(resource) {}
+
+// Storage copy constructor, the views index into the copied elements
+template <typename T, typename Traits>
+BasicMagicalContainer<T, Traits>::Storage::Storage(const Storage &other, std::pmr::memory_resource *resource)
+    : regular(other.regular, resource),
+      cross(other.cross, resource),
+      sort(other.sort, resource),
+      prime(other.prime, resource),
+      fingerprint(other.fingerprint)
+{
+    views.reserve(other.views.size());
+    for (const auto &view : other.views)
     {
-        if (num % i == 0)
-            return false;
+        views.push_back(view->clone(resource));
     }
-    return true;
+}
+
+// Shared storage of the unmodified empty containers
+template <typename T, typename Traits>
+const std::shared_ptr<typename BasicMagicalContainer<T, Traits>::Storage> &BasicMagicalContainer<T, Traits>::emptyStorage()
+{
+    static const std::shared_ptr<Storage> empty = std::make_shared<Storage>(std::pmr::get_default_resource());
+    return empty;
+}
+
+// Detach from the copies sharing our storage
+template <typename T, typename Traits>
+typename BasicMagicalContainer<T, Traits>::Storage &BasicMagicalContainer<T, Traits>::mutate()
+{
+    if (data.use_count() != 1)
+    {
+        data = std::allocate_shared<Storage>(std::pmr::polymorphic_allocator<Storage>(resource), *data, resource);
+    }
+    else
+    {
+        // use_count() is a relaxed load; the fence pairs it with the release decrement of the
+        // last copy dropped on another thread, so that copy's reads happen before our writes
+        std::atomic_thread_fence(std::memory_order_acquire);
+    }
+    return *data;
 }
 
 // Copy constructor
-MagicalContainer::MagicalContainer(const MagicalContainer &other)
-    : regular(other.regular),
-      cross(other.cross),
-      sort(other.sort),
-      prime(other.prime) {}
+template <typename T, typename Traits>
+BasicMagicalContainer<T, Traits>::BasicMagicalContainer(const BasicMagicalContainer &other)
+    : resource(other.resource),
+      data(other.data) {}
+
+// Allocator-extended copy constructor
+template <typename T, typename Traits>
+BasicMagicalContainer<T, Traits>::BasicMagicalContainer(const BasicMagicalContainer &other, std::pmr::memory_resource *resource)
+    : resource(resource),
+      data(other.data)
+{
+    if (resource != other.resource)
+        mutate();
+}
 
 // Copy assignment operator
-MagicalContainer &MagicalContainer::operator=(const MagicalContainer &other)
+template <typename T, typename Traits>
+BasicMagicalContainer<T, Traits> &BasicMagicalContainer<T, Traits>::operator=(const BasicMagicalContainer &other)
 {
     if (this == &other)
         return *this;
 
-    regular = other.regular;
-    cross = other.cross;
-    sort = other.sort;
-    prime = other.prime;
+    data = other.data;
+    // keep our memory resource, the shared storage is copied into it if it came from another one
+    if (resource != other.resource)
+        mutate();
 
     return *this;
 }
 
 // Move constructor
-MagicalContainer::MagicalContainer(MagicalContainer &&other) noexcept
-    : regular(std::move(other.regular)),
-      cross(std::move(other.cross)),
-      sort(std::move(other.sort)),
-      prime(std::move(other.prime)) {}
-
-// Move assignment operator
-MagicalContainer &MagicalContainer::operator=(MagicalContainer &&other) noexcept
+template <typename T, typename Traits>
+BasicMagicalContainer<T, Traits>::BasicMagicalContainer(BasicMagicalContainer &&other) noexcept
+    : resource(other.resource),
+      data(std::exchange(other.data, emptyStorage())) {}
+
+// Move assignment operator, copying into this resource first when the resources differ
+template <typename T, typename Traits>
+BasicMagicalContainer<T, Traits> &BasicMagicalContainer<T, Traits>::operator=(BasicMagicalContainer &&other)
 {
     if (this == &other)
         return *this;
 
-    regular = std::move(other.regular);
-    cross = std::move(other.cross);
-    sort = std::move(other.sort);
-    prime = std::move(other.prime);
+    if (resource != other.resource)
+        data = std::allocate_shared<Storage>(std::pmr::polymorphic_allocator<Storage>(resource), *other.data, resource);
+    else
+        data = std::move(other.data);
+    other.data = emptyStorage();
 
     return *this;
 }
 
 // Copy assignment operator for BasicIterator
-MagicalContainer::BasicIterator &MagicalContainer::BasicIterator::operator=(const BasicIterator &other)
+template <typename T, typename Traits>
+typename BasicMagicalContainer<T, Traits>::BasicIterator &BasicMagicalContainer<T, Traits>::BasicIterator::operator=(const BasicIterator &other)
 {
     if (this->magicalContainer != other.magicalContainer)
         throw std::runtime_error("Cant assign from iterator of a different MagicalContainer");
 
     magicalContainer = other.magicalContainer;
     pos = other.pos;
-    it = other.it;
     return *this;
 }
 
 // Helper functions
-void ariel::MagicalContainer::initCross(std::vector<int *> &cross)
+template <typename T, typename Traits>
+void BasicMagicalContainer<T, Traits>::initCross(std::pmr::vector<index_type> &cross)
 {
+    // clear() keeps the capacity, so the buffer is refilled without re-growing
     cross.clear();
+    cross.reserve(data->sort.size());
 }
 
-void ariel::MagicalContainer::updateFromStart(std::vector<int *>::iterator &start_it, std::vector<int *> &cross)
+template <typename T, typename Traits>
+void BasicMagicalContainer<T, Traits>::updateFromStart(const index_type *&start_it, std::pmr::vector<index_type> &cross)
 {
     cross.push_back(*start_it);
     ++start_it;
 }
 
-void ariel::MagicalContainer::updateFromEnd(std::vector<int *>::reverse_iterator &end_it, std::vector<int *> &cross)
+template <typename T, typename Traits>
+void BasicMagicalContainer<T, Traits>::updateFromEnd(std::reverse_iterator<const index_type *> &end_it, std::pmr::vector<index_type> &cross)
 {
     cross.push_back(*end_it);
     ++end_it;
 }
 
 // MagicalContainer member function
-void MagicalContainer::optimise_cross()
+template <typename T, typename Traits>
+void BasicMagicalContainer<T, Traits>::optimise_cross()
 {
+    MAGICAL_STATS(StatsTimer timer(statistics.crossNanoseconds));
+    MAGICAL_STATS(++statistics.crossRebuilds);
+    auto &cross = data->cross.fresh();
+    const auto &sort = data->sort;
     initCross(cross);
-    auto start_it = sort.begin();
-    auto end_it = sort.rbegin();
+    const index_type *start_it = sort.data().begin();
+    auto end_it = std::make_reverse_iterator(sort.data().end());
 
     bool add_from_start = true;
 
-    for (int i = 0; i < sort.size(); i++)
+    for (size_t i = 0; i < sort.size(); i++)
     {
         if (add_from_start)
         {
@@ -114,105 +307,685 @@ void MagicalContainer::optimise_cross()
     }
 }
 
-bool ariel::MagicalContainer::BasicIterator::compareIntPointers(int *a, int *b)
+// Rebuild the ascending view with the radix kernel of the element type
+template <typename T, typename Traits>
+void BasicMagicalContainer<T, Traits>::optimise_sort()
 {
-    return *a < *b;
+    MAGICAL_STATS(StatsTimer timer(statistics.sortNanoseconds));
+    MAGICAL_STATS(++statistics.sortRebuilds);
+    MAGICAL_STATS(statistics.rebuiltElements += data->regular.size());
+    MAGICAL_STATS(statistics.largestRebuild = std::max<std::uint64_t>(statistics.largestRebuild, data->regular.size()));
+    data->sort.rebuild(data->regular.data(), data->regular.size());
 }
 
-// The 'optimise_sort()' function utilizing the helper function
-void MagicalContainer::optimise_sort()
+// Update the prime vector
+template <typename T, typename Traits>
+void BasicMagicalContainer<T, Traits>::optimise_prime()
 {
-    sort.clear();
+    MAGICAL_STATS(StatsTimer timer(statistics.primeNanoseconds));
+    MAGICAL_STATS(++statistics.primeRebuilds);
+    MAGICAL_STATS(statistics.rebuiltElements += data->regular.size());
+    MAGICAL_STATS(statistics.primeChecks += data->regular.size());
+    MAGICAL_STATS(statistics.largestRebuild = std::max<std::uint64_t>(statistics.largestRebuild, data->regular.size()));
+    data->prime.rebuild(data->regular.data(), data->regular.size());
+}
 
-    for (auto it = regular.begin(); it != regular.end(); ++it)
+// Rebuild the user-defined views
+template <typename T, typename Traits>
+void BasicMagicalContainer<T, Traits>::optimise_views()
+{
+    MAGICAL_STATS(StatsTimer timer(statistics.viewNanoseconds));
+    for (auto &view : data->views)
     {
-        sort.push_back(&(*it));
+        MAGICAL_STATS(++statistics.viewRebuilds);
+        MAGICAL_STATS(statistics.rebuiltElements += data->regular.size());
+        view->rebuild(data->regular.data(), data->regular.size());
     }
+}
 
-    std::sort(sort.begin(), sort.end(), BasicIterator::compareIntPointers);
+// Rebuild every view after a bulk change
+template <typename T, typename Traits>
+void BasicMagicalContainer<T, Traits>::optimise_all()
+{
+    optimise_prime();
+    optimise_sort();
+    optimise_views();
+    optimise_cross();
 }
 
-// Update the prime vector
-void MagicalContainer::optimise_prime()
+// Default constructor
+template <typename T, typename Traits>
+BasicMagicalContainer<T, Traits>::BasicMagicalContainer()
+    : BasicMagicalContainer(std::pmr::get_default_resource()) {}
+
+// Constructor with a memory resource, the storage is allocated on the first modification
+template <typename T, typename Traits>
+BasicMagicalContainer<T, Traits>::BasicMagicalContainer(std::pmr::memory_resource *resource)
+    : resource(resource),
+      data(emptyStorage()) {}
+
+// Destructor
+template <typename T, typename Traits>
+BasicMagicalContainer<T, Traits>::~BasicMagicalContainer() = default;
+
+// Add an element to the container
+template <typename T, typename Traits>
+void BasicMagicalContainer<T, Traits>::addElement(T element)
 {
-    prime.clear();
+    if (data->regular.size() >= std::numeric_limits<index_type>::max())
+        throw std::length_error("MagicalContainer is full for its index type");
 
-    for (auto it = regular.begin(); it != regular.end(); ++it)
+    Storage &storage = mutate();
+    auto &regular = storage.regular.own();
+    regular.push_back(element);
+    storage.fingerprint.append(element);
+
+    // the filter and order views take the new element in place
     {
-        if (isPrime(*it))
+        MAGICAL_STATS(StatsTimer timer(statistics.incrementalNanoseconds));
+        MAGICAL_STATS(statistics.incrementalUpdates += 2 + storage.views.size());
+        MAGICAL_STATS(++statistics.primeChecks);
+        storage.prime.inserted(regular.data(), regular.size());
+        storage.sort.inserted(regular.data(), regular.size());
+        for (auto &view : storage.views)
         {
-            prime.push_back(&(*it));
+            view->inserted(regular.data(), regular.size());
         }
     }
+    optimise_cross();
 }
 
-// Default constructor
-MagicalContainer::MagicalContainer() = default;
+// Add many elements, rebuilding the views once
+template <typename T, typename Traits>
+void BasicMagicalContainer<T, Traits>::addElements(std::span<const T> elements)
+{
+    if (elements.size() > std::numeric_limits<index_type>::max() - data->regular.size())
+        throw std::length_error("MagicalContainer is full for its index type");
 
-// Destructor
-MagicalContainer::~MagicalContainer() = default;
+    Storage &storage = mutate();
+    auto &regular = storage.regular.own();
+    regular.insert(regular.end(), elements.begin(), elements.end());
+    storage.fingerprint.append(elements.data(), elements.size());
 
-// Add an element to the container
-void MagicalContainer::addElement(int element)
+    optimise_all();
+}
+
+// Append the elements of another storage, merging the views
+template <typename T, typename Traits>
+void BasicMagicalContainer<T, Traits>::mergeFrom(const Storage &other)
 {
-    regular.push_back(element);
-    optimise_prime();
-    optimise_sort();
+    size_t offset = data->regular.size();
+    if (other.regular.size() > std::numeric_limits<index_type>::max() - offset)
+        throw std::length_error("MagicalContainer is full for its index type");
+    if (other.regular.empty())
+        return;
+
+    Storage &storage = mutate();
+    auto &regular = storage.regular.own();
+    regular.insert(regular.end(), other.regular.begin(), other.regular.end());
+    storage.sort.merge(regular.data(), other.sort, offset);
+    storage.prime.append(other.prime, offset);
+    storage.fingerprint.concat(other.fingerprint);
+    optimise_views();
     optimise_cross();
 }
 
+// Move the elements of another container to the end of this one
+template <typename T, typename Traits>
+void BasicMagicalContainer<T, Traits>::merge(BasicMagicalContainer &&other)
+{
+    if (&other == this)
+        throw std::invalid_argument("Cannot merge a container into itself");
+    if (data->regular.empty() && data->views.empty() && resource == other.resource)
+        data = other.data;
+    else
+        mergeFrom(*other.data);
+    other.data = emptyStorage();
+}
+
+// Merge two containers into a new one
+template <typename T, typename Traits>
+BasicMagicalContainer<T, Traits> BasicMagicalContainer<T, Traits>::merged(const BasicMagicalContainer &a, const BasicMagicalContainer &b)
+{
+    BasicMagicalContainer result(a);
+    result.mergeFrom(*b.data);
+    return result;
+}
+
+// Run a set algorithm over the ascending values of both containers
+template <typename T, typename Traits>
+template <typename Combine>
+BasicMagicalContainer<T, Traits> BasicMagicalContainer<T, Traits>::combined(const BasicMagicalContainer &other, Combine combine) const
+{
+    auto ascending = [](const Storage &storage)
+    {
+        const T *values = storage.regular.data();
+        return std::views::transform(storage.sort.data(), [values](index_type index)
+                                     { return values[index]; });
+    };
+
+    BasicMagicalContainer result(resource);
+    Storage &storage = result.mutate();
+    auto &regular = storage.regular.own();
+    combine(ascending(*data), ascending(*other.data), std::back_inserter(regular));
+    if (regular.size() > std::numeric_limits<index_type>::max())
+        throw std::length_error("MagicalContainer is full for its index type");
+
+    storage.sort.rebuildOrdered(regular.size());
+    storage.fingerprint = Fingerprint<T>::of(regular.data(), regular.size());
+    result.optimise_prime();
+    result.optimise_cross();
+    return result;
+}
+
+// Multiset union
+template <typename T, typename Traits>
+BasicMagicalContainer<T, Traits> BasicMagicalContainer<T, Traits>::unionWith(const BasicMagicalContainer &other) const
+{
+    return combined(other, std::ranges::set_union);
+}
+
+// Multiset intersection
+template <typename T, typename Traits>
+BasicMagicalContainer<T, Traits> BasicMagicalContainer<T, Traits>::intersection(const BasicMagicalContainer &other) const
+{
+    return combined(other, std::ranges::set_intersection);
+}
+
+// Multiset difference
+template <typename T, typename Traits>
+BasicMagicalContainer<T, Traits> BasicMagicalContainer<T, Traits>::difference(const BasicMagicalContainer &other) const
+{
+    return combined(other, std::ranges::set_difference);
+}
+
+// Multiset symmetric difference
+template <typename T, typename Traits>
+BasicMagicalContainer<T, Traits> BasicMagicalContainer<T, Traits>::symmetricDifference(const BasicMagicalContainer &other) const
+{
+    return combined(other, std::ranges::set_symmetric_difference);
+}
+
+// Parse a text stream in chunks straight into the element storage
+template <typename T, typename Traits>
+size_t BasicMagicalContainer<T, Traits>::ingest(std::istream &input)
+{
+    Storage &storage = mutate();
+    auto &regular = storage.regular.own();
+    size_t before = regular.size();
+
+    std::vector<char> buffer(ingestChunkSize);
+    size_t carried = 0;
+    try
+    {
+        while (true)
+        {
+            input.read(buffer.data() + carried, static_cast<std::streamsize>(buffer.size() - carried));
+            size_t filled = carried + static_cast<size_t>(input.gcount());
+            bool final = !input;
+            const char *stop = parseIntegers(buffer.data(), buffer.data() + filled, final, regular);
+            if (final)
+                break;
+
+            // move the unfinished token to the front, growing the buffer for oversized tokens
+            carried = static_cast<size_t>(buffer.data() + filled - stop);
+            std::memmove(buffer.data(), stop, carried);
+            if (carried == buffer.size())
+                buffer.resize(buffer.size() * 2);
+        }
+        if (input.bad())
+            throw std::runtime_error("Cant read the ingested stream");
+        if (regular.size() > std::numeric_limits<index_type>::max())
+            throw std::length_error("MagicalContainer is full for its index type");
+    }
+    catch (...)
+    {
+        regular.resize(before);
+        throw;
+    }
+
+    storage.fingerprint.append(regular.data() + before, regular.size() - before);
+    optimise_all();
+    return regular.size() - before;
+}
+
+// Parse a memory-mapped text file straight into the element storage
+template <typename T, typename Traits>
+size_t BasicMagicalContainer<T, Traits>::ingest(const std::string &path)
+{
+    int file = ::open(path.c_str(), O_RDONLY);
+    if (file < 0)
+        throw std::runtime_error("Cant open ingested file " + path);
+
+    struct stat status = {};
+    if (::fstat(file, &status) != 0)
+    {
+        ::close(file);
+        throw std::runtime_error("Cant read ingested file " + path);
+    }
+    auto fileSize = static_cast<size_t>(status.st_size);
+    if (fileSize == 0)
+    {
+        ::close(file);
+        return 0;
+    }
+
+    void *address = ::mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE, file, 0);
+    ::close(file);
+    if (address == MAP_FAILED)
+        throw std::runtime_error("Cant map ingested file " + path);
+    ::madvise(address, fileSize, MADV_SEQUENTIAL);
+    std::shared_ptr<void> mapping(address, [fileSize](void *mapped)
+                                  { ::munmap(mapped, fileSize); });
+
+    Storage &storage = mutate();
+    auto &regular = storage.regular.own();
+    size_t before = regular.size();
+    try
+    {
+        const auto *text = static_cast<const char *>(address);
+        parseIntegers(text, text + fileSize, true, regular);
+        if (regular.size() > std::numeric_limits<index_type>::max())
+            throw std::length_error("MagicalContainer is full for its index type");
+    }
+    catch (...)
+    {
+        regular.resize(before);
+        throw;
+    }
+
+    storage.fingerprint.append(regular.data() + before, regular.size() - before);
+    optimise_all();
+    return regular.size() - before;
+}
+
 // Remove an element from the container
-void MagicalContainer::removeElement(int element)
+template <typename T, typename Traits>
+void BasicMagicalContainer<T, Traits>::removeElement(T element)
 {
-    auto it = std::find(regular.begin(), regular.end(), element);
+    auto found = std::find(data->regular.begin(), data->regular.end(), element);
 
-    if (it == regular.end())
+    if (found == data->regular.end())
     {
         throw std::runtime_error("Element not found in container");
-        return;
     }
 
-    int *p = &(*it);
+    auto index = static_cast<size_t>(found - data->regular.begin());
+    Storage &storage = mutate();
+    auto &regular = storage.regular.own();
 
-    regular.erase(it);
+    // the views look the element up by value, so they are updated before it is erased
+    {
+        MAGICAL_STATS(StatsTimer timer(statistics.incrementalNanoseconds));
+        MAGICAL_STATS(statistics.incrementalUpdates += 2 + storage.views.size());
+        storage.fingerprint.erase(regular.data(), index);
+        storage.prime.erased(regular.data(), index);
+        storage.sort.erased(regular.data(), index);
+        for (auto &view : storage.views)
+        {
+            view->erased(regular.data(), index);
+        }
 
-    sort.erase(std::find(sort.begin(), sort.end(), p));
+        regular.erase(regular.begin() + static_cast<std::ptrdiff_t>(index));
+    }
+    optimise_cross();
+}
 
-    if (isPrime(element))
+// Write a snapshot of the container and its views
+template <typename T, typename Traits>
+void BasicMagicalContainer<T, Traits>::save(const std::string &path) const
+{
+    const Storage &storage = *data;
+
+    SnapshotHeader header{};
+    header.magic = snapshotMagic;
+    header.version = snapshotVersion;
+    header.byteOrder = snapshotByteOrder;
+    header.elementSize = sizeof(T);
+    header.elementSigned = std::is_signed_v<T> ? 1 : 0;
+    header.indexSize = sizeof(index_type);
+    header.count = storage.regular.size();
+    header.primeCount = storage.prime.size();
+    header.regularOffset = alignSnapshotOffset(sizeof(SnapshotHeader));
+    header.sortOffset = alignSnapshotOffset(header.regularOffset + header.count * sizeof(T));
+    header.crossOffset = alignSnapshotOffset(header.sortOffset + header.count * sizeof(index_type));
+    header.primeOffset = alignSnapshotOffset(header.crossOffset + header.count * sizeof(index_type));
+    header.orderedHash = storage.fingerprint.ordered();
+    header.multisetHash = storage.fingerprint.multiset();
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out)
+        throw std::runtime_error("Cant create snapshot file " + path);
+
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    writeSnapshotArray(out, header.regularOffset, storage.regular.data(), storage.regular.size());
+    writeSnapshotArray(out, header.sortOffset, storage.sort.data().data(), storage.sort.size());
+    writeSnapshotArray(out, header.crossOffset, storage.cross.data(), storage.cross.size());
+    writeSnapshotArray(out, header.primeOffset, storage.prime.data().data(), storage.prime.size());
+
+    out.flush();
+    if (!out)
+        throw std::runtime_error("Cant write snapshot file " + path);
+}
+
+// Map a snapshot file, the columns read from the mapping until they are modified
+template <typename T, typename Traits>
+BasicMagicalContainer<T, Traits> BasicMagicalContainer<T, Traits>::open(const std::string &path, std::pmr::memory_resource *resource)
+{
+    int file = ::open(path.c_str(), O_RDONLY);
+    if (file < 0)
+        throw std::runtime_error("Cant open snapshot file " + path);
+
+    struct stat status = {};
+    if (::fstat(file, &status) != 0 || static_cast<size_t>(status.st_size) < sizeof(SnapshotHeader))
     {
-        prime.erase(std::find(prime.begin(), prime.end(), p));
+        ::close(file);
+        throw std::runtime_error("Not a MagicalContainer snapshot: " + path);
     }
-    optimise_prime();
-    optimise_cross();
-    optimise_sort();
+
+    auto fileSize = static_cast<size_t>(status.st_size);
+    void *address = ::mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE, file, 0);
+    ::close(file);
+    if (address == MAP_FAILED)
+        throw std::runtime_error("Cant map snapshot file " + path);
+
+    std::shared_ptr<const void> mapping(address, [fileSize](const void *mapped)
+                                        { ::munmap(const_cast<void *>(mapped), fileSize); });
+    const auto *bytes = static_cast<const char *>(address);
+
+    SnapshotHeader header{};
+    std::memcpy(&header, bytes, sizeof(header));
+    bool valid = header.magic == snapshotMagic &&
+                 header.version == snapshotVersion &&
+                 header.byteOrder == snapshotByteOrder &&
+                 header.elementSize == sizeof(T) &&
+                 header.elementSigned == (std::is_signed_v<T> ? 1U : 0U) &&
+                 header.indexSize == sizeof(index_type) &&
+                 header.primeCount <= header.count &&
+                 snapshotArrayFits(header.regularOffset, header.count, sizeof(T), fileSize) &&
+                 snapshotArrayFits(header.sortOffset, header.count, sizeof(index_type), fileSize) &&
+                 snapshotArrayFits(header.crossOffset, header.count, sizeof(index_type), fileSize) &&
+                 snapshotArrayFits(header.primeOffset, header.primeCount, sizeof(index_type), fileSize);
+    if (!valid)
+        throw std::runtime_error("Not a compatible MagicalContainer snapshot: " + path);
+
+    auto count = static_cast<size_t>(header.count);
+    auto storage = std::allocate_shared<Storage>(std::pmr::polymorphic_allocator<Storage>(resource), resource);
+    storage->regular.borrow(reinterpret_cast<const T *>(bytes + header.regularOffset), count);
+    storage->sort.borrow(reinterpret_cast<const index_type *>(bytes + header.sortOffset), count);
+    storage->cross.borrow(reinterpret_cast<const index_type *>(bytes + header.crossOffset), count);
+    storage->prime.borrow(reinterpret_cast<const index_type *>(bytes + header.primeOffset), static_cast<size_t>(header.primeCount));
+    storage->fingerprint = Fingerprint<T>::restore(header.orderedHash, header.multisetHash, count);
+    storage->mapping = std::move(mapping);
+
+    BasicMagicalContainer result(resource);
+    result.data = std::move(storage);
+    return result;
 }
 
 // Get the size of the container
-size_t MagicalContainer::size() const
+template <typename T, typename Traits>
+size_t BasicMagicalContainer<T, Traits>::size() const
+{
+    return data->regular.size();
+}
+
+// Position of the first element >= value in the ascending view
+template <typename T, typename Traits>
+size_t BasicMagicalContainer<T, Traits>::lowerRank(T value) const
+{
+    const T *values = data->regular.data();
+    auto it = std::partition_point(data->sort.data().begin(), data->sort.data().end(),
+                                   [values, value](index_type index)
+                                   { return values[index] < value; });
+    return static_cast<size_t>(it - data->sort.data().begin());
+}
+
+// Position of the first element > value in the ascending view
+template <typename T, typename Traits>
+size_t BasicMagicalContainer<T, Traits>::upperRank(T value) const
+{
+    const T *values = data->regular.data();
+    auto it = std::partition_point(data->sort.data().begin(), data->sort.data().end(),
+                                   [values, value](index_type index)
+                                   { return !(value < values[index]); });
+    return static_cast<size_t>(it - data->sort.data().begin());
+}
+
+// Elements in [low, high) in ascending order
+template <typename T, typename Traits>
+typename BasicMagicalContainer<T, Traits>::AscendingRange BasicMagicalContainer<T, Traits>::range(T low, T high)
+{
+    AscendingIterator first(*this);
+    if (!(low < high))
+        return AscendingRange(first, first);
+    AscendingIterator last = first.lowerBound(high);
+    return AscendingRange(first.lowerBound(low), last);
+}
+
+// Yield the values of an index order; the storage stays alive while the generator is
+template <typename T, typename Traits>
+Generator<T> BasicMagicalContainer<T, Traits>::generate(std::shared_ptr<const Storage> storage, const Column<index_type> *order, size_t first)
+{
+    for (size_t pos = first; pos < order->size(); ++pos)
+        co_yield storage->regular[(*order)[pos]];
+}
+
+// Lazy ascending sequence
+template <typename T, typename Traits>
+Generator<T> BasicMagicalContainer<T, Traits>::ascending() const
+{
+    return generate(data, &data->sort.data(), 0);
+}
+
+// Lazy ascending sequence from the first element >= low
+template <typename T, typename Traits>
+Generator<T> BasicMagicalContainer<T, Traits>::ascendingFrom(T low) const
+{
+    return generate(data, &data->sort.data(), lowerRank(low));
+}
+
+// Lazy side-cross sequence
+template <typename T, typename Traits>
+Generator<T> BasicMagicalContainer<T, Traits>::sideCross() const
+{
+    return generate(data, &data->cross, 0);
+}
+
+// Lazy sequence of the primes in insertion order
+template <typename T, typename Traits>
+Generator<T> BasicMagicalContainer<T, Traits>::primes() const
+{
+    return generate(data, &data->prime.data(), 0);
+}
+
+// Element of rank k in ascending order
+template <typename T, typename Traits>
+T BasicMagicalContainer<T, Traits>::kthSmallest(size_t k) const
+{
+    if (k >= data->sort.size())
+        throw std::runtime_error("Rank is out of range");
+    return data->regular[data->sort[k]];
+}
+
+// Lower median
+template <typename T, typename Traits>
+T BasicMagicalContainer<T, Traits>::median() const
+{
+    if (data->sort.size() == 0)
+        throw std::runtime_error("Median of an empty container");
+    return kthSmallest((data->sort.size() - 1) / 2);
+}
+
+// Nearest-rank percentile
+template <typename T, typename Traits>
+T BasicMagicalContainer<T, Traits>::percentile(double p) const
+{
+    if (!(p >= 0 && p <= 100))
+        throw std::runtime_error("Percentile must be in [0, 100]");
+    size_t count = data->sort.size();
+    if (count == 0)
+        throw std::runtime_error("Percentile of an empty container");
+    // multiplying before dividing keeps whole ranks exact (7 * 100 / 100, not 0.07 * 100); the
+    // rounding error left for fractional p is relative, so it is shaved off before ceil
+    double exact = p * static_cast<double>(count) / 100;
+    auto rank = static_cast<size_t>(std::ceil(exact * (1 - 4 * std::numeric_limits<double>::epsilon())));
+    return kthSmallest(rank == 0 ? 0 : std::min(rank, count) - 1);
+}
+
+// Count of the elements in [low, high]
+template <typename T, typename Traits>
+size_t BasicMagicalContainer<T, Traits>::countInRange(T low, T high)
 {
-    return regular.size();
+    return view<RangeIndex>().countInRange(low, high);
+}
+
+// Sum of the elements in [low, high]
+template <typename T, typename Traits>
+typename Traits::sum_type BasicMagicalContainer<T, Traits>::sumInRange(T low, T high)
+{
+    return view<RangeIndex>().sumInRange(low, high);
+}
+
+// Compress the ascending view and the primality of its elements
+template <typename T, typename Traits>
+BasicFrozenContainer<T> BasicMagicalContainer<T, Traits>::freeze(std::pmr::memory_resource *resource) const
+{
+    size_t count = data->regular.size();
+    std::vector<std::uint8_t> primeByIndex(count, 0);
+    for (index_type index : data->prime.data())
+        primeByIndex[index] = 1;
+
+    std::vector<T> ascending(count);
+    std::vector<std::uint8_t> primeFlags(count);
+    for (size_t rank = 0; rank < count; ++rank)
+    {
+        index_type index = data->sort[rank];
+        ascending[rank] = data->regular[index];
+        primeFlags[rank] = primeByIndex[index];
+    }
+    return BasicFrozenContainer<T>(ascending, primeFlags, resource);
+}
+
+// Get the memory footprint of each part
+template <typename T, typename Traits>
+typename BasicMagicalContainer<T, Traits>::MemoryUsage BasicMagicalContainer<T, Traits>::memoryUsage() const
+{
+    MemoryUsage usage;
+    usage.regular = data->regular.footprint();
+    usage.sort = data->sort.footprint();
+    usage.cross = data->cross.footprint();
+    usage.prime = data->prime.footprint();
+    for (const auto &view : data->views)
+    {
+        usage.views += view->footprint();
+    }
+    usage.scratch = data->sort.scratchBytes();
+    usage.shared = data.use_count() > 1;
+    return usage;
+}
+
+// Get the instrumentation counters
+template <typename T, typename Traits>
+const typename BasicMagicalContainer<T, Traits>::Stats &BasicMagicalContainer<T, Traits>::stats() const
+{
+#ifdef MAGICAL_CONTAINER_STATS
+    return statistics;
+#else
+    static const Stats zero;
+    return zero;
+#endif
+}
+
+// Zero the instrumentation counters
+template <typename T, typename Traits>
+void BasicMagicalContainer<T, Traits>::resetStats()
+{
+    statistics = Counters{};
+}
+
+// Whether the counters are compiled in
+template <typename T, typename Traits>
+bool BasicMagicalContainer<T, Traits>::statsEnabled()
+{
+#ifdef MAGICAL_CONTAINER_STATS
+    return true;
+#else
+    return false;
+#endif
+}
+
+// Reserve room in the storage and in every view
+template <typename T, typename Traits>
+void BasicMagicalContainer<T, Traits>::reserve(size_t capacity)
+{
+    Storage &storage = mutate();
+    storage.regular.own().reserve(capacity);
+    storage.cross.own().reserve(capacity);
+    storage.sort.reserve(capacity);
+    // the prime view is usually much smaller than the container, so it keeps growing on demand
+}
+
+// Get the allocator of the container
+template <typename T, typename Traits>
+typename BasicMagicalContainer<T, Traits>::allocator_type BasicMagicalContainer<T, Traits>::get_allocator() const
+{
+    return allocator_type(resource);
 }
 
 // Equality comparison operator
-bool MagicalContainer::operator==(const MagicalContainer &other) const
+template <typename T, typename Traits>
+bool BasicMagicalContainer<T, Traits>::operator==(const BasicMagicalContainer &other) const
 {
-    return regular == other.regular;
+    if (data == other.data)
+        return true;
+    if (data->regular.size() != other.data->regular.size() ||
+        data->fingerprint.ordered() != other.data->fingerprint.ordered())
+        return false;
+    return std::equal(data->regular.begin(), data->regular.end(), other.data->regular.begin());
 }
 
 // Inequality comparison operator
-bool MagicalContainer::operator!=(const MagicalContainer &other) const
+template <typename T, typename Traits>
+bool BasicMagicalContainer<T, Traits>::operator!=(const BasicMagicalContainer &other) const
+{
+    return !(*this == other);
+}
+
+// Multiset equality
+template <typename T, typename Traits>
+bool BasicMagicalContainer<T, Traits>::sameElements(const BasicMagicalContainer &other) const
 {
-    return regular != other.regular;
+    if (data == other.data)
+        return true;
+    if (data->regular.size() != other.data->regular.size() ||
+        data->fingerprint.multiset() != other.data->fingerprint.multiset())
+        return false;
+    const T *values = data->regular.data();
+    const T *otherValues = other.data->regular.data();
+    return std::equal(data->sort.data().begin(), data->sort.data().end(), other.data->sort.data().begin(),
+                      [values, otherValues](index_type a, index_type b)
+                      { return values[a] == otherValues[b]; });
+}
+
+// Content hashes
+template <typename T, typename Traits>
+const Fingerprint<T> &BasicMagicalContainer<T, Traits>::fingerprint() const
+{
+    return data->fingerprint;
 }
 
 // BasicIterator constructor
-MagicalContainer::BasicIterator::BasicIterator(MagicalContainer &magicalContainer) : magicalContainer(&magicalContainer), pos(0){};
+template <typename T, typename Traits>
+BasicMagicalContainer<T, Traits>::BasicIterator::BasicIterator(BasicMagicalContainer &magicalContainer) : magicalContainer(&magicalContainer), pos(0){};
 
 // BasicIterator copy constructor
-MagicalContainer::BasicIterator::BasicIterator(const BasicIterator &other) : magicalContainer(other.magicalContainer), pos(other.pos){};
+template <typename T, typename Traits>
+BasicMagicalContainer<T, Traits>::BasicIterator::BasicIterator(const BasicIterator &other) : magicalContainer(other.magicalContainer), pos(other.pos){};
 
 // BasicIterator equality comparison operator
-bool MagicalContainer::BasicIterator::operator==(const BasicIterator &other) const
+template <typename T, typename Traits>
+bool BasicMagicalContainer<T, Traits>::BasicIterator::operator==(const BasicIterator &other) const
 {
     if (this->magicalContainer != other.magicalContainer)
         throw std::invalid_argument("Cant compare iterators from different MagicalContainers");
@@ -221,7 +994,8 @@ bool MagicalContainer::BasicIterator::operator==(const BasicIterator &other) con
 }
 
 // BasicIterator inequality comparison operator
-bool MagicalContainer::BasicIterator::operator!=(const BasicIterator &other) const
+template <typename T, typename Traits>
+bool BasicMagicalContainer<T, Traits>::BasicIterator::operator!=(const BasicIterator &other) const
 {
     if (this->magicalContainer != other.magicalContainer)
         throw std::invalid_argument("Cant compare iterators from different MagicalContainers");
@@ -230,7 +1004,8 @@ bool MagicalContainer::BasicIterator::operator!=(const BasicIterator &other) con
 }
 
 // BasicIterator less than comparison operator
-bool MagicalContainer::BasicIterator::operator<(const BasicIterator &other) const
+template <typename T, typename Traits>
+bool BasicMagicalContainer<T, Traits>::BasicIterator::operator<(const BasicIterator &other) const
 {
     if (this->magicalContainer != other.magicalContainer)
         throw std::invalid_argument("Cant compare iterators from different MagicalContainers");
@@ -239,7 +1014,8 @@ bool MagicalContainer::BasicIterator::operator<(const BasicIterator &other) cons
 }
 
 // BasicIterator greater than comparison operator
-bool MagicalContainer::BasicIterator::operator>(const BasicIterator &other) const
+template <typename T, typename Traits>
+bool BasicMagicalContainer<T, Traits>::BasicIterator::operator>(const BasicIterator &other) const
 {
     if (this->magicalContainer != other.magicalContainer)
         throw std::invalid_argument("Cant compare iterators from different MagicalContainers");
@@ -248,82 +1024,154 @@ bool MagicalContainer::BasicIterator::operator>(const BasicIterator &other) cons
 }
 
 // BasicIterator destructor
-MagicalContainer::BasicIterator::~BasicIterator() = default;
+template <typename T, typename Traits>
+BasicMagicalContainer<T, Traits>::BasicIterator::~BasicIterator() = default;
 
 // BasicIterator move constructor
-MagicalContainer::BasicIterator::BasicIterator(BasicIterator &&other) noexcept
-    : magicalContainer(other.magicalContainer), pos(other.pos), it(std::move(other.it)) {}
+template <typename T, typename Traits>
+BasicMagicalContainer<T, Traits>::BasicIterator::BasicIterator(BasicIterator &&other) noexcept
+    : magicalContainer(other.magicalContainer), pos(other.pos) {}
 
-// AscendingIterator constructor
-MagicalContainer::AscendingIterator::AscendingIterator(MagicalContainer &magicalContainer) : BasicIterator(magicalContainer)
+// Copy a batch of values through an index order
+template <typename T, typename Traits>
+size_t BasicMagicalContainer<T, Traits>::BasicIterator::gather(const Column<index_type> &order, std::span<T> out)
+{
+    size_t available = pos < order.size() ? order.size() - pos : 0;
+    size_t count = std::min(out.size(), available);
+    const T *values = magicalContainer->data->regular.data();
+    const index_type *indices = order.data() + pos;
+    for (size_t i = 0; i < count; ++i)
+        out[i] = values[indices[i]];
+    pos += count;
+    return count;
+}
+
+// Move forward within a traversal
+template <typename T, typename Traits>
+void BasicMagicalContainer<T, Traits>::BasicIterator::advance(size_t steps, size_t size)
 {
-    it = magicalContainer.sort.begin();
-};
+    if (pos > size || steps > size - pos)
+        throw std::runtime_error("Iterator is out of range");
+    pos += steps;
+}
+
+// AscendingIterator constructor
+template <typename T, typename Traits>
+BasicMagicalContainer<T, Traits>::AscendingIterator::AscendingIterator(BasicMagicalContainer &magicalContainer) : BasicIterator(magicalContainer){};
 
 // AscendingIterator copy constructor
-MagicalContainer::AscendingIterator::AscendingIterator(const AscendingIterator &other) : BasicIterator(other){};
+template <typename T, typename Traits>
+BasicMagicalContainer<T, Traits>::AscendingIterator::AscendingIterator(const AscendingIterator &other) : BasicIterator(other){};
 
 // AscendingIterator copy assignment operator
-MagicalContainer::AscendingIterator &MagicalContainer::AscendingIterator::operator=(const AscendingIterator &other)
+template <typename T, typename Traits>
+typename BasicMagicalContainer<T, Traits>::AscendingIterator &BasicMagicalContainer<T, Traits>::AscendingIterator::operator=(const AscendingIterator &other)
 {
     if (this->magicalContainer != other.magicalContainer)
         throw std::runtime_error("Cant copy from another container");
-    magicalContainer = other.magicalContainer;
-    pos = other.pos;
-    it = other.it;
+    this->magicalContainer = other.magicalContainer;
+    this->pos = other.pos;
     return *this;
 }
 
 // Dereference operator for AscendingIterator
-int MagicalContainer::AscendingIterator::operator*() const
+template <typename T, typename Traits>
+T BasicMagicalContainer<T, Traits>::AscendingIterator::operator*() const
 {
-    if (it == magicalContainer->sort.end())
+    if (this->pos >= this->magicalContainer->data->sort.size())
         throw std::runtime_error("Iterator is out of range");
-    return **it;
+    return this->magicalContainer->data->regular[this->magicalContainer->data->sort[this->pos]];
 }
 
 // Pre-increment operator for AscendingIterator
-MagicalContainer::AscendingIterator &MagicalContainer::AscendingIterator::operator++()
+template <typename T, typename Traits>
+typename BasicMagicalContainer<T, Traits>::AscendingIterator &BasicMagicalContainer<T, Traits>::AscendingIterator::operator++()
 {
-    if (it == magicalContainer->sort.end())
+    if (this->pos >= this->magicalContainer->data->sort.size())
     {
         throw std::runtime_error("Iterator is out of range");
-        return *this;
     }
-    ++it;
-    ++pos;
+    ++this->pos;
     return *this;
 }
 
+// Advance operator for AscendingIterator
+template <typename T, typename Traits>
+typename BasicMagicalContainer<T, Traits>::AscendingIterator &BasicMagicalContainer<T, Traits>::AscendingIterator::operator+=(size_t steps)
+{
+    this->advance(steps, this->magicalContainer->data->sort.size());
+    return *this;
+}
+
+// Batch fetch for AscendingIterator
+template <typename T, typename Traits>
+size_t BasicMagicalContainer<T, Traits>::AscendingIterator::fetchBatch(std::span<T> out)
+{
+    return this->gather(this->magicalContainer->data->sort.data(), out);
+}
+
 // Begin function for AscendingIterator
-MagicalContainer::AscendingIterator MagicalContainer::AscendingIterator::begin()
+template <typename T, typename Traits>
+typename BasicMagicalContainer<T, Traits>::AscendingIterator BasicMagicalContainer<T, Traits>::AscendingIterator::begin()
 {
     AscendingIterator temp(*this);
-    temp.it = magicalContainer->sort.begin();
     temp.pos = 0;
     return temp;
 }
 
 // End function for AscendingIterator
-MagicalContainer::AscendingIterator MagicalContainer::AscendingIterator::end()
+template <typename T, typename Traits>
+typename BasicMagicalContainer<T, Traits>::AscendingIterator BasicMagicalContainer<T, Traits>::AscendingIterator::end()
 {
     AscendingIterator temp(*this);
-    temp.it = magicalContainer->sort.end();
-    temp.pos = magicalContainer->sort.size();
+    temp.pos = this->magicalContainer->data->sort.size();
     return temp;
 }
 
-// SideCrossIterator constructor
-MagicalContainer::SideCrossIterator::SideCrossIterator(MagicalContainer &magicalContainer) : BasicIterator(magicalContainer)
+// Split function for AscendingIterator
+template <typename T, typename Traits>
+std::vector<typename BasicMagicalContainer<T, Traits>::template Range<typename BasicMagicalContainer<T, Traits>::AscendingIterator>> BasicMagicalContainer<T, Traits>::AscendingIterator::split(size_t parts)
+{
+    return Range<AscendingIterator>(begin(), end()).split(parts);
+}
+
+// Lower bound function for AscendingIterator
+template <typename T, typename Traits>
+typename BasicMagicalContainer<T, Traits>::AscendingIterator BasicMagicalContainer<T, Traits>::AscendingIterator::lowerBound(T value) const
+{
+    AscendingIterator temp(*this);
+    temp.pos = this->magicalContainer->lowerRank(value);
+    return temp;
+}
+
+// Upper bound function for AscendingIterator
+template <typename T, typename Traits>
+typename BasicMagicalContainer<T, Traits>::AscendingIterator BasicMagicalContainer<T, Traits>::AscendingIterator::upperBound(T value) const
+{
+    AscendingIterator temp(*this);
+    temp.pos = this->magicalContainer->upperRank(value);
+    return temp;
+}
+
+// Equal range function for AscendingIterator
+template <typename T, typename Traits>
+std::pair<typename BasicMagicalContainer<T, Traits>::AscendingIterator, typename BasicMagicalContainer<T, Traits>::AscendingIterator>
+BasicMagicalContainer<T, Traits>::AscendingIterator::equalRange(T value) const
 {
-    it = magicalContainer.cross.begin();
-};
+    return {lowerBound(value), upperBound(value)};
+}
+
+// SideCrossIterator constructor
+template <typename T, typename Traits>
+BasicMagicalContainer<T, Traits>::SideCrossIterator::SideCrossIterator(BasicMagicalContainer &magicalContainer) : BasicIterator(magicalContainer){};
 
 // SideCrossIterator copy constructor
-MagicalContainer::SideCrossIterator::SideCrossIterator(const SideCrossIterator &other) : BasicIterator(other){};
+template <typename T, typename Traits>
+BasicMagicalContainer<T, Traits>::SideCrossIterator::SideCrossIterator(const SideCrossIterator &other) : BasicIterator(other){};
 
 // SideCrossIterator copy assignment operator
-MagicalContainer::SideCrossIterator &MagicalContainer::SideCrossIterator::operator=(const SideCrossIterator &other)
+template <typename T, typename Traits>
+typename BasicMagicalContainer<T, Traits>::SideCrossIterator &BasicMagicalContainer<T, Traits>::SideCrossIterator::operator=(const SideCrossIterator &other)
 {
     // Check if both iterators belong to the same container
     if (this->magicalContainer != other.magicalContainer)
@@ -334,10 +1182,8 @@ MagicalContainer::SideCrossIterator &MagicalContainer::SideCrossIterator::operat
     // Check for self-assignment
     if (this != &other)
     {
-        // Assign each data member from the source object to this object
         // Assuming that magicalContainer should be the same for both, so no need to copy
-        pos = other.pos;
-        it = other.it;
+        this->pos = other.pos;
     }
 
     // Return a reference to this object
@@ -345,104 +1191,121 @@ MagicalContainer::SideCrossIterator &MagicalContainer::SideCrossIterator::operat
 }
 
 // Dereference operator for SideCrossIterator
-int MagicalContainer::SideCrossIterator::operator*() const
+template <typename T, typename Traits>
+T BasicMagicalContainer<T, Traits>::SideCrossIterator::operator*() const
 {
-    if (it == magicalContainer->cross.end())
+    if (this->pos >= this->magicalContainer->data->cross.size())
         throw std::runtime_error("Iterator is out of range");
-    return **it;
+    return this->magicalContainer->data->regular[this->magicalContainer->data->cross[this->pos]];
 }
 
 // Pre-increment operator for SideCrossIterator
-MagicalContainer::SideCrossIterator &MagicalContainer::SideCrossIterator::operator++()
+template <typename T, typename Traits>
+typename BasicMagicalContainer<T, Traits>::SideCrossIterator &BasicMagicalContainer<T, Traits>::SideCrossIterator::operator++()
 {
     // Check if iterator is at the end
-    if (it == magicalContainer->cross.end())
+    if (this->pos >= this->magicalContainer->data->cross.size())
     {
         throw std::runtime_error("Iterator is out of range");
     }
 
-    // Increment the iterator and position
-    ++it;
-    ++pos;
+    // Increment the position
+    ++this->pos;
 
     // Return a reference to this object
     return *this;
 }
 
+// Advance operator for SideCrossIterator
+template <typename T, typename Traits>
+typename BasicMagicalContainer<T, Traits>::SideCrossIterator &BasicMagicalContainer<T, Traits>::SideCrossIterator::operator+=(size_t steps)
+{
+    this->advance(steps, this->magicalContainer->data->cross.size());
+    return *this;
+}
+
+// Batch fetch for SideCrossIterator
+template <typename T, typename Traits>
+size_t BasicMagicalContainer<T, Traits>::SideCrossIterator::fetchBatch(std::span<T> out)
+{
+    return this->gather(this->magicalContainer->data->cross, out);
+}
+
 // Begin function for SideCrossIterator
-MagicalContainer::SideCrossIterator MagicalContainer::SideCrossIterator::begin()
+template <typename T, typename Traits>
+typename BasicMagicalContainer<T, Traits>::SideCrossIterator BasicMagicalContainer<T, Traits>::SideCrossIterator::begin()
 {
     SideCrossIterator temp(*this);
-    temp.it = magicalContainer->cross.begin();
     temp.pos = 0;
     return temp;
 }
 
 // End function for SideCrossIterator
-MagicalContainer::SideCrossIterator MagicalContainer::SideCrossIterator::end()
+template <typename T, typename Traits>
+typename BasicMagicalContainer<T, Traits>::SideCrossIterator BasicMagicalContainer<T, Traits>::SideCrossIterator::end()
 {
     // Create a new iterator that points to the end of the cross vector
-    SideCrossIterator endIterator(*magicalContainer);
-    endIterator.it = magicalContainer->cross.end();
-    endIterator.pos = magicalContainer->cross.size();
+    SideCrossIterator endIterator(*this->magicalContainer);
+    endIterator.pos = this->magicalContainer->data->cross.size();
 
     return endIterator;
 }
 
-// PrimeIterator constructor
-MagicalContainer::PrimeIterator::PrimeIterator(MagicalContainer &magicalContainer) : BasicIterator(magicalContainer)
+// Split function for SideCrossIterator
+template <typename T, typename Traits>
+std::vector<typename BasicMagicalContainer<T, Traits>::template Range<typename BasicMagicalContainer<T, Traits>::SideCrossIterator>> BasicMagicalContainer<T, Traits>::SideCrossIterator::split(size_t parts)
 {
-    it = magicalContainer.prime.begin();
-};
+    return Range<SideCrossIterator>(begin(), end()).split(parts);
+}
+
+// PrimeIterator constructor
+template <typename T, typename Traits>
+BasicMagicalContainer<T, Traits>::PrimeIterator::PrimeIterator(BasicMagicalContainer &magicalContainer) : BasicIterator(magicalContainer){};
 
 // PrimeIterator copy constructor
-MagicalContainer::PrimeIterator::PrimeIterator(const PrimeIterator &other) : BasicIterator(other){};
+template <typename T, typename Traits>
+BasicMagicalContainer<T, Traits>::PrimeIterator::PrimeIterator(const PrimeIterator &other) : BasicIterator(other){};
 
 // PrimeIterator copy assignment operator
-MagicalContainer::PrimeIterator &MagicalContainer::PrimeIterator::operator=(const PrimeIterator &other)
+template <typename T, typename Traits>
+typename BasicMagicalContainer<T, Traits>::PrimeIterator &BasicMagicalContainer<T, Traits>::PrimeIterator::operator=(const PrimeIterator &other)
 {
-    if (&other == this)
+    if (is_self_assignment(other))
     {
         // self-assignment, do nothing
         return *this;
     }
 
-    // Check if the iterator is from the same container
-    if (this->magicalContainer != other.magicalContainer)
-    {
-        throw std::runtime_error("Can't copy from another container");
-    }
-
     // Copy-and-swap idiom
     PrimeIterator temp(other);
-    std::swap(magicalContainer, temp.magicalContainer);
-    std::swap(pos, temp.pos);
-    std::swap(it, temp.it);
+    swap_with_temp(temp);
 
     return *this;
 }
 
 // Dereference operator for PrimeIterator
-int MagicalContainer::PrimeIterator::operator*() const
+template <typename T, typename Traits>
+T BasicMagicalContainer<T, Traits>::PrimeIterator::operator*() const
 {
-    if (it == magicalContainer->prime.end())
+    if (this->pos >= this->magicalContainer->data->prime.size())
         throw std::runtime_error("Iterator is out of range");
-    return **it;
+    return this->magicalContainer->data->regular[this->magicalContainer->data->prime[this->pos]];
 }
 
 // Pre-increment operator for PrimeIterator
-MagicalContainer::PrimeIterator &MagicalContainer::PrimeIterator::operator++()
+template <typename T, typename Traits>
+typename BasicMagicalContainer<T, Traits>::PrimeIterator &BasicMagicalContainer<T, Traits>::PrimeIterator::operator++()
 {
-    if (it == magicalContainer->prime.end())
+    if (this->pos >= this->magicalContainer->data->prime.size())
     {
         throw std::runtime_error("Iterator is out of range");
-        return *this;
     }
-    ++it;
-    ++pos;
+    ++this->pos;
     return *this;
 }
-bool MagicalContainer::PrimeIterator::is_self_assignment(const PrimeIterator &other) const
+
+template <typename T, typename Traits>
+bool BasicMagicalContainer<T, Traits>::PrimeIterator::is_self_assignment(const PrimeIterator &other) const
 {
     if (&other == this)
     {
@@ -457,28 +1320,58 @@ bool MagicalContainer::PrimeIterator::is_self_assignment(const PrimeIterator &ot
     return false;
 }
 
-void MagicalContainer::PrimeIterator::swap_with_temp(PrimeIterator &temp)
+template <typename T, typename Traits>
+void BasicMagicalContainer<T, Traits>::PrimeIterator::swap_with_temp(PrimeIterator &temp)
 {
-    std::swap(magicalContainer, temp.magicalContainer);
-    std::swap(pos, temp.pos);
-    std::swap(it, temp.it);
+    std::swap(this->magicalContainer, temp.magicalContainer);
+    std::swap(this->pos, temp.pos);
 }
 
+// Advance operator for PrimeIterator
+template <typename T, typename Traits>
+typename BasicMagicalContainer<T, Traits>::PrimeIterator &BasicMagicalContainer<T, Traits>::PrimeIterator::operator+=(size_t steps)
+{
+    this->advance(steps, this->magicalContainer->data->prime.size());
+    return *this;
+}
+
+// Batch fetch for PrimeIterator
+template <typename T, typename Traits>
+size_t BasicMagicalContainer<T, Traits>::PrimeIterator::fetchBatch(std::span<T> out)
+{
+    return this->gather(this->magicalContainer->data->prime.data(), out);
+}
 
 // Begin function for PrimeIterator
-MagicalContainer::PrimeIterator MagicalContainer::PrimeIterator::begin()
+template <typename T, typename Traits>
+typename BasicMagicalContainer<T, Traits>::PrimeIterator BasicMagicalContainer<T, Traits>::PrimeIterator::begin()
 {
     PrimeIterator temp(*this);
-    temp.it = magicalContainer->prime.begin();
     temp.pos = 0;
     return temp;
 }
 
 // End function for PrimeIterator
-MagicalContainer::PrimeIterator MagicalContainer::PrimeIterator::end()
+template <typename T, typename Traits>
+typename BasicMagicalContainer<T, Traits>::PrimeIterator BasicMagicalContainer<T, Traits>::PrimeIterator::end()
 {
     PrimeIterator temp(*this);
-    temp.it = magicalContainer->prime.end();
-    temp.pos = magicalContainer->prime.size();
+    temp.pos = this->magicalContainer->data->prime.size();
     return temp;
 }
+
+// Split function for PrimeIterator
+template <typename T, typename Traits>
+std::vector<typename BasicMagicalContainer<T, Traits>::template Range<typename BasicMagicalContainer<T, Traits>::PrimeIterator>> BasicMagicalContainer<T, Traits>::PrimeIterator::split(size_t parts)
+{
+    return Range<PrimeIterator>(begin(), end()).split(parts);
+}
+
+// The element types the container is compiled for
+template class ariel::BasicMagicalContainer<int>;
+template class ariel::BasicMagicalContainer<std::uint32_t>;
+template class ariel::BasicMagicalContainer<std::int64_t>;
+template class ariel::BasicMagicalContainer<std::uint64_t>;
+template class ariel::BasicMagicalContainer<std::int64_t, ariel::WideElementTraits<std::int64_t>>;
+template class ariel::BasicMagicalContainer<std::uint64_t, ariel::WideElementTraits<std::uint64_t>>;
+template class ariel::BasicMagicalContainer<int, ariel::CompactElementTraits<int>>;
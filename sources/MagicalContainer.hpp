@@ -2,10 +2,12 @@
  * @file MagicalContainer.hpp
  * @brief Defines the MagicalContainer class and its nested iterator classes.
  * @details The MagicalContainer class is a container that stores a collection of integers
- * with various ordering options. It provides functionality to add and remove elements,
+ * with various ordering options. It is a template over the integer element type;
+ * MagicalContainer itself is the `int` instantiation. It provides functionality to add and remove elements,
  * retrieve the size of the container, and compare containers for equality.
  * The container supports three iterator classes: AscendingIterator, SideCrossIterator,
- * and PrimeIterator, which allow iteration over the container in different orderings.
+ * and PrimeIterator, which allow iteration over the container in different orderings,
+ * plus FilterIterator and OrderIterator over user-defined views (see Views.hpp).
  *
  * @author Maya Rom
  * @ID 207485251
@@ -14,20 +16,147 @@
 #pragma once
 
 #include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iosfwd>
+#include <iterator>
+#include <memory>
+#include <memory_resource>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <utility>
 #include <vector>
 
+#include "Column.hpp"
+#include "ElementTraits.hpp"
+#include "Fingerprint.hpp"
+#include "Generator.hpp"
+#include "Views.hpp"
+
 namespace ariel
 {
+    template <typename T>
+    class BasicFrozenContainer;
+
     /**
-     * @class MagicalContainer
+     * @class BasicMagicalContainer
      * @brief A container that stores a collection of integers with various ordering options.
+     * @tparam T The integer element type; see ElementTraits for the per-type kernels.
+     * @tparam Traits The per-type configuration; its index_type bounds the number of elements,
+     * 2^32 - 1 with the default 32-bit indices (see WideElementTraits for more).
      */
-    class MagicalContainer
+    template <typename T, typename Traits = ElementTraits<T>>
+    class BasicMagicalContainer
     {
-        std::vector<int> regular; // stores original insertion order
-        std::vector<int *> cross; // stores element pointers in cross order
-        std::vector<int *> sort;  // stores element pointers in ascending order
-        std::vector<int *> prime; // stores element pointers that are prime numbers in original order
+    public:
+        using value_type = T;
+        using traits_type = Traits;
+        using index_type = typename traits_type::index_type;
+        using allocator_type = std::pmr::polymorphic_allocator<T>;
+
+        /**
+         * @brief A view of the elements accepted by Predicate, in insertion order.
+         */
+        template <typename Predicate>
+        using Filter = FilterView<T, index_type, Predicate>;
+
+        /**
+         * @brief A view of all the elements ordered by Compare.
+         */
+        template <typename Compare>
+        using Order = OrderView<T, index_type, Compare>;
+
+        /**
+         * @brief An index of the counts and sums of the elements over value ranges.
+         */
+        using RangeIndex = FenwickIndex<T, index_type>;
+
+    private:
+        /**
+         * @struct Storage
+         * @brief The elements and their views, shared copy-on-write between copies of a container.
+         */
+        struct Storage
+        {
+            Column<T> regular;                              // stores original insertion order
+            Column<index_type> cross;                       // stores element indices in cross order
+            Order<std::less<T>> sort;                       // stores element indices in ascending order
+            Filter<IsPrime> prime;                          // stores element indices that are prime numbers in original order
+            std::vector<std::unique_ptr<AnyView<T>>> views; // user-defined views, maintained like the built-in ones
+            std::shared_ptr<const void> mapping;            // keeps a loaded snapshot mapped while the columns borrow from it
+            Fingerprint<T> fingerprint;                     // hashes of the elements, kept up to date by every mutation
+
+            explicit Storage(std::pmr::memory_resource *resource);
+            Storage(const Storage &other, std::pmr::memory_resource *resource);
+        };
+
+    public:
+        /**
+         * @struct Stats
+         * @brief Where the mutation time of a container goes.
+         * @details The counters are only kept when MAGICAL_CONTAINER_STATS is defined (see
+         * statsEnabled()); otherwise stats() reads zero and a container holds no counters at all.
+         * The macro changes the layout of the container, so every translation unit must agree on it.
+         */
+        struct Stats
+        {
+            std::uint64_t sortRebuilds = 0;             // full rebuilds of the ascending view (optimise_sort)
+            std::uint64_t primeRebuilds = 0;            // full rebuilds of the prime view (optimise_prime)
+            std::uint64_t crossRebuilds = 0;            // rebuilds of the cross view (optimise_cross)
+            std::uint64_t viewRebuilds = 0;             // full rebuilds of the user-defined views (optimise_views)
+            std::uint64_t sortNanoseconds = 0;          // time spent in optimise_sort
+            std::uint64_t primeNanoseconds = 0;         // time spent in optimise_prime
+            std::uint64_t crossNanoseconds = 0;         // time spent in optimise_cross
+            std::uint64_t viewNanoseconds = 0;          // time spent in optimise_views
+            std::uint64_t rebuiltElements = 0;          // elements processed by all the full rebuilds together
+            std::uint64_t largestRebuild = 0;           // size of the largest view rebuilt from scratch
+            std::uint64_t incrementalUpdates = 0;       // in-place view updates by addElement and removeElement
+            std::uint64_t incrementalNanoseconds = 0;   // time spent in the in-place view updates
+            std::uint64_t primeChecks = 0;              // isPrime invocations
+        };
+
+        /**
+         * @struct MemoryUsage
+         * @brief Bytes used and allocated by the element storage and by each view.
+         * @details Arrays read from a mapped snapshot count as used but not as allocated.
+         */
+        struct MemoryUsage
+        {
+            Footprint regular;   // the elements
+            Footprint sort;      // the ascending view
+            Footprint cross;     // the cross view
+            Footprint prime;     // the prime view
+            Footprint views;     // all the user-defined views together
+            size_t scratch = 0;  // radix sorting buffers kept between rebuilds of the ascending view
+            bool shared = false; // the storage is shared with copies, which report the same bytes
+
+            size_t used() const { return regular.used + sort.used + cross.used + prime.used + views.used; }
+            size_t capacity() const { return regular.capacity + sort.capacity + cross.capacity + prime.capacity + views.capacity + scratch; }
+        };
+
+    private:
+        std::pmr::memory_resource *resource; // allocates the storage and the views
+        std::shared_ptr<Storage> data;       // never null; shared with copies until one of them mutates
+#ifdef MAGICAL_CONTAINER_STATS
+        using Counters = Stats;
+#else
+        struct Counters
+        {
+        };
+#endif
+        [[no_unique_address]] Counters statistics; // per container object, copies start from zero
+
+        /**
+         * @brief The storage of all the empty containers that have not been modified yet.
+         */
+        static const std::shared_ptr<Storage> &emptyStorage();
+
+        /**
+         * @brief Give this container a private copy of its storage before modifying it.
+         * @return The storage, owned by this container only.
+         */
+        Storage &mutate();
 
         /**
   * @brief Check if a number is prime.
@@ -35,7 +164,7 @@ namespace ariel
   * @return true if the number is prime, false otherwise.
 
   */
-        bool isPrime(int number) const;
+        bool isPrime(T number) const;
 
         /**
          * @brief Update the cross order elements.
@@ -52,6 +181,77 @@ namespace ariel
          */
         void optimise_prime();
 
+        /**
+         * @brief Rebuild every user-defined view.
+         */
+        void optimise_views();
+
+        /**
+         * @brief Rebuild every view from scratch, after a bulk change of the elements.
+         */
+        void optimise_all();
+
+        /**
+         * @brief Append the elements of other, merging the views instead of rebuilding them.
+         */
+        void mergeFrom(const Storage &other);
+
+        /**
+         * @brief Build a container from the ascending values of this container and other.
+         * @param combine A std::ranges set algorithm writing the result in ascending order.
+         */
+        template <typename Combine>
+        BasicMagicalContainer combined(const BasicMagicalContainer &other, Combine combine) const;
+
+        /**
+         * @brief Binary search the ascending view for the first element >= value.
+         * @return Its position in the ascending view, or size() if there is none.
+         */
+        size_t lowerRank(T value) const;
+
+        /**
+         * @brief Binary search the ascending view for the first element > value.
+         * @return Its position in the ascending view, or size() if there is none.
+         */
+        size_t upperRank(T value) const;
+
+        /**
+         * @brief Yield the elements of an index order from position `first` on.
+         * @param storage Kept alive by the coroutine, so later mutations copy it instead of changing it.
+         * @param order One of the index orders of storage.
+         */
+        static Generator<T> generate(std::shared_ptr<const Storage> storage, const Column<index_type> *order, size_t first);
+
+        /**
+         * @brief Find the slot of a user-defined view, registering and building it on first use.
+         * @return The position of the view in `views`.
+         */
+        template <typename View>
+        size_t viewSlot()
+        {
+            const void *key = AnyView<T>::template keyOf<View>();
+            for (size_t slot = 0; slot < data->views.size(); ++slot)
+            {
+                if (data->views[slot]->key() == key)
+                    return slot;
+            }
+            // registering a view changes the storage, so it must not leak into other copies
+            Storage &storage = mutate();
+            auto holder = std::make_unique<ViewHolder<T, View>>(resource);
+            holder->rebuild(storage.regular.data(), storage.regular.size());
+            storage.views.push_back(std::move(holder));
+            return storage.views.size() - 1;
+        }
+
+        /**
+         * @brief Access the user-defined view registered in `slot`.
+         */
+        template <typename View>
+        const View &viewAt(size_t slot) const
+        {
+            return static_cast<const ViewHolder<T, View> &>(*data->views[slot]).view;
+        }
+
         /**
          * @class BasicIterator
          * @brief Base class for the iterator classes of MagicalContainer.
@@ -60,16 +260,27 @@ namespace ariel
         class BasicIterator
         {
         protected:
-            MagicalContainer *magicalContainer;
+            BasicMagicalContainer *magicalContainer;
             size_t pos;
-            std::vector<int *>::iterator it;
+
+            /**
+             * @brief Copy the values of the next elements of `order` into out, checking the bounds once.
+             * @return The number of values written.
+             */
+            size_t gather(const Column<index_type> &order, std::span<T> out);
+
+            /**
+             * @brief Move forward by `steps` elements of a traversal of `size` elements.
+             * @throws std::runtime_error if that goes past the end.
+             */
+            void advance(size_t steps, size_t size);
 
         public:
             /**
              * @brief Constructs a new BasicIterator object.
              * @param magicalContainer The MagicalContainer to iterate over.
              */
-            BasicIterator(MagicalContainer &magicalContainer);
+            BasicIterator(BasicMagicalContainer &magicalContainer);
 
             /**
              * @brief Copy constructor for BasicIterator.
@@ -130,58 +341,164 @@ namespace ariel
              */
             bool operator<(const BasicIterator &other) const;
 
-            // A helper function to compare the integers that the pointers point to
-            static bool compareIntPointers(int *a, int *b);
+            /**
+             * @brief Get the number of elements before the iterator in its traversal order.
+             */
+            size_t position() const { return pos; }
         };
 
     public:
         /**
          * @brief Constructs a new MagicalContainer object.
          */
-        MagicalContainer();
+        BasicMagicalContainer();
+
+        /**
+         * @brief Constructs a new MagicalContainer object whose storage and views
+         * are allocated from the given memory resource.
+         * @param resource The memory resource to allocate from (must outlive the container).
+         */
+        explicit BasicMagicalContainer(std::pmr::memory_resource *resource);
+
+        /**
+         * @brief Allocator-extended copy constructor for MagicalContainer.
+         * @details Shares the storage of `other` when it uses the same memory resource,
+         * and copies it into `resource` otherwise.
+         * @param other The MagicalContainer object to copy.
+         * @param resource The memory resource the copy allocates from.
+         */
+        BasicMagicalContainer(const BasicMagicalContainer &other, std::pmr::memory_resource *resource);
 
         /**
          * @brief Destructor for MagicalContainer.
          */
-        ~MagicalContainer();
+        ~BasicMagicalContainer();
 
         /**
          * @brief Copy constructor for MagicalContainer.
+         * @details O(1): the copy shares the elements and views of `other` and allocates
+         * from the same memory resource; either container takes a private copy on its
+         * first modification.
          * @param other The MagicalContainer object to copy.
          */
-        MagicalContainer(const MagicalContainer &other);
+        BasicMagicalContainer(const BasicMagicalContainer &other);
 
         /**
          * @brief Copy assignment operator for MagicalContainer.
          * @param other The MagicalContainer object to copy.
          * @return Reference to the copied MagicalContainer object.
          */
-        MagicalContainer &operator=(const MagicalContainer &other);
+        BasicMagicalContainer &operator=(const BasicMagicalContainer &other);
 
         /**
          * @brief Move constructor for MagicalContainer.
          * @param other The MagicalContainer object to move.
          */
-        MagicalContainer(MagicalContainer &&other) noexcept;
+        BasicMagicalContainer(BasicMagicalContainer &&other) noexcept;
 
         /**
          * @brief Move assignment operator for MagicalContainer.
+         * @details Takes over the storage when both containers use the same memory resource;
+         * otherwise copies it into this container's resource, like std::pmr::vector does for
+         * unequal allocators. Neither container changes if that copy fails.
          * @param other The MagicalContainer object to move.
          * @return Reference to the moved MagicalContainer object.
+         * @throws std::bad_alloc if the copy across resources cannot be allocated.
          */
-        MagicalContainer &operator=(MagicalContainer &&other) noexcept;
+        BasicMagicalContainer &operator=(BasicMagicalContainer &&other);
 
         /**
          * @brief Add an element to the container.
          * @param element The element to add.
+         * @throws std::length_error if the container already holds as many elements as index_type can address.
+         */
+        void addElement(T element);
+
+        /**
+         * @brief Add many elements at once.
+         * @details The elements are appended in order and every view is rebuilt once at the end,
+         * instead of being updated per element.
+         * @param elements The elements to add.
+         * @throws std::length_error if the container would hold more elements than index_type can address.
+         */
+        void addElements(std::span<const T> elements);
+
+        /**
+         * @brief Add the integers of a text stream.
+         * @details Integers are separated by whitespace or commas. The stream is read in large
+         * chunks and parsed with std::from_chars straight into the element storage; the views
+         * are rebuilt once at the end. On error the container is left unchanged.
+         * @param input The stream to read until its end.
+         * @return The number of elements added.
+         * @throws std::runtime_error if a token is not an integer of the element type.
+         */
+        size_t ingest(std::istream &input);
+
+        /**
+         * @brief Add the integers of a text file, memory-mapping it instead of reading it.
+         * @param path The file to read.
+         * @return The number of elements added.
+         * @throws std::runtime_error if the file cannot be read or a token is not an integer of the element type.
+         */
+        size_t ingest(const std::string &path);
+
+        /**
+         * @brief Append all the elements of other after the elements of this container.
+         * @details The ascending view is built by a linear merge of both ascending views and
+         * the prime view by joining both prime views, so no element is sorted or tested again;
+         * the cross view and the user-defined views are then rebuilt from the merged result.
+         * @param other The container to take the elements from; it is left empty.
+         * @throws std::invalid_argument if other is this container.
+         * @throws std::length_error if the index type cannot address all the elements.
+         */
+        void merge(BasicMagicalContainer &&other);
+
+        /**
+         * @brief Get a container with the elements of a followed by the elements of b, in O(n).
+         * @param a The first container.
+         * @param b The second container.
+         * @return The merged container, allocating from the memory resource of a.
+         * @throws std::length_error if the index type cannot address all the elements.
+         */
+        static BasicMagicalContainer merged(const BasicMagicalContainer &a, const BasicMagicalContainer &b);
+
+        /**
+         * @brief Get the multiset union: each value as many times as in whichever container has more of it.
+         * @details Like the other set operations it co-iterates both ascending views in
+         * O(n + m); the result stores its elements in ascending order with every view built.
+         * @param other The other container.
+         * @return A new container allocating from the memory resource of this one.
+         * @throws std::length_error if the index type cannot address all the elements.
+         */
+        BasicMagicalContainer unionWith(const BasicMagicalContainer &other) const;
+
+        /**
+         * @brief Get the multiset intersection: each value as many times as in whichever container has fewer of it.
+         * @param other The other container.
+         * @return A new container with its elements in ascending order.
+         */
+        BasicMagicalContainer intersection(const BasicMagicalContainer &other) const;
+
+        /**
+         * @brief Get the multiset difference: each value as many times as it occurs here beyond its count in other.
+         * @param other The container whose elements are taken away.
+         * @return A new container with its elements in ascending order.
+         */
+        BasicMagicalContainer difference(const BasicMagicalContainer &other) const;
+
+        /**
+         * @brief Get the multiset symmetric difference: each value as many times as its counts differ.
+         * @param other The other container.
+         * @return A new container with its elements in ascending order.
+         * @throws std::length_error if the index type cannot address all the elements.
          */
-        void addElement(int element);
+        BasicMagicalContainer symmetricDifference(const BasicMagicalContainer &other) const;
 
         /**
          * @brief Remove an element from the container.
          * @param element The element to remove.
          */
-        void removeElement(int element);
+        void removeElement(T element);
 
         /**
          * @brief Get the size of the container.
@@ -189,22 +506,214 @@ namespace ariel
          */
         size_t size() const;
 
+        /**
+         * @brief Get the k-th smallest element, counting from 0, in O(1) from the ascending view.
+         * @param k The rank of the element; equal elements take consecutive ranks.
+         * @return The element of rank k.
+         * @throws std::runtime_error if k >= size().
+         */
+        T kthSmallest(size_t k) const;
+
+        /**
+         * @brief Get the median element.
+         * @details With an even number of elements this is the lower of the two middle
+         * elements, so the result is always an element of the container.
+         * @return The element of rank (size() - 1) / 2.
+         * @throws std::runtime_error if the container is empty.
+         */
+        T median() const;
+
+        /**
+         * @brief Get the p-th percentile with the nearest-rank method.
+         * @param p The percentile, in [0, 100]; 0 gives the smallest element and 100 the largest.
+         * @return The smallest element such that at least p% of the elements are <= it.
+         * @throws std::runtime_error if the container is empty or p is outside [0, 100].
+         */
+        T percentile(double p) const;
+
+        /**
+         * @brief Count the elements in [low, high] in O(log n).
+         * @details The first call registers a RangeIndex view, which addElement and
+         * removeElement keep up to date from then on; containers that never ask pay nothing.
+         * @param low The smallest value counted.
+         * @param high The largest value counted.
+         * @return The number of elements in the range, 0 when high < low.
+         */
+        size_t countInRange(T low, T high);
+
+        /**
+         * @brief Sum the elements in [low, high] in O(log n), registering a RangeIndex on first use.
+         * @param low The smallest value summed.
+         * @param high The largest value summed.
+         * @return The sum of the elements in the range, 0 when high < low.
+         */
+        typename traits_type::sum_type sumInRange(T low, T high);
+
+        /**
+         * @brief Get an immutable, compressed copy of the container for cold storage.
+         * @details The copy keeps the elements in ascending order, delta-encoded and bit-packed,
+         * and the primality of each one in a bitmap taken from the prime view; see FrozenContainer.hpp.
+         * @param resource The memory resource of the frozen copy.
+         * @return The frozen copy; this container is left unchanged and can be dropped.
+         */
+        BasicFrozenContainer<T> freeze(std::pmr::memory_resource *resource = std::pmr::get_default_resource()) const;
+
+        /**
+         * @brief Get the memory used by the elements and by every view.
+         * @return The footprint of each part of the container.
+         */
+        MemoryUsage memoryUsage() const;
+
+        /**
+         * @brief Get the instrumentation counters of this container.
+         * @return The counters since construction or the last resetStats().
+         */
+        const Stats &stats() const;
+
+        /**
+         * @brief Zero the instrumentation counters.
+         */
+        void resetStats();
+
+        /**
+         * @brief Check whether the library was built with MAGICAL_CONTAINER_STATS.
+         * @return true if stats() is updated, false if it always reads zero.
+         */
+        static bool statsEnabled();
+
+        /**
+         * @brief Reserve room for at least `capacity` elements in the storage and in the
+         * ascending and cross views, so that later insertions and view rebuilds do not re-grow their buffers.
+         * @param capacity The number of elements to reserve for.
+         */
+        void reserve(size_t capacity);
+
+        /**
+         * @brief Write the elements and the prebuilt ascending, cross and prime views to a snapshot file.
+         * @details The file holds a versioned header followed by the element array and the
+         * index permutation of each view, in native byte order.
+         * @param path The file to create or overwrite.
+         * @throws std::runtime_error if the file cannot be written.
+         */
+        void save(const std::string &path) const;
+
+        /**
+         * @brief Load a snapshot written by save() by memory-mapping it.
+         * @details Nothing is read or rebuilt up front: the container and its views read
+         * from the mapping and pages fault in on demand. The first modification copies
+         * the touched arrays into memory from `resource`. The file contents are trusted;
+         * only the header and the array bounds are checked.
+         * @param path The snapshot file.
+         * @param resource The memory resource to allocate from once the container is modified.
+         * @return The loaded container.
+         * @throws std::runtime_error if the file cannot be mapped or is not a snapshot of this element type.
+         */
+        static BasicMagicalContainer open(const std::string &path, std::pmr::memory_resource *resource = std::pmr::get_default_resource());
+
+        /**
+         * @brief Get the allocator the container and its views allocate from.
+         * @return The polymorphic allocator wrapping the container's memory resource.
+         */
+        allocator_type get_allocator() const;
+
+        /**
+         * @brief Get a user-defined view of the container, registering it on first use.
+         * @details Once registered, the view is kept up to date by addElement and
+         * removeElement incrementally, exactly like the built-in views.
+         * @tparam View A Filter<Predicate> or Order<Compare> of this container.
+         * @return The view, valid until the container is modified.
+         */
+        template <typename View>
+        const View &view()
+        {
+            return viewAt<View>(viewSlot<View>());
+        }
+
         /**
          * @brief Equality operator for MagicalContainer.
+         * @details Containers with different sizes or insertion-order hashes are told
+         * apart in O(1); only containers that are probably equal are compared element by element.
          * @param other The MagicalContainer object to compare.
-         * @return true if the containers are equal, false otherwise.
+         * @return true if the containers hold the same elements in the same insertion order, false otherwise.
          */
-        bool operator==(const MagicalContainer &other) const;
+        bool operator==(const BasicMagicalContainer &other) const;
 
         /**
          * @brief Inequality operator for MagicalContainer.
          * @param other The MagicalContainer object to compare.
          * @return true if the containers are not equal, false otherwise.
          */
-        bool operator!=(const MagicalContainer &other) const;
+        bool operator!=(const BasicMagicalContainer &other) const;
+
+        /**
+         * @brief Check whether two containers hold the same elements, in any insertion order.
+         * @details Rejects in O(1) on the sizes and the multiset hashes, otherwise compares
+         * the ascending views in O(n) without sorting.
+         * @param other The MagicalContainer object to compare.
+         * @return true if every value occurs the same number of times in both containers.
+         */
+        bool sameElements(const BasicMagicalContainer &other) const;
+
+        /**
+         * @brief Get the content hashes of the container, maintained by every mutation.
+         * @return The insertion-order and multiset hashes of the elements.
+         */
+        const Fingerprint<T> &fingerprint() const;
 
         // Nested classes
 
+        /**
+         * @class Range
+         * @brief A contiguous part [first, last) of one traversal of the container.
+         * @details Like the iterators, a range reads the container through its position,
+         * so it is invalidated by adding or removing elements. Ranges of an unmodified
+         * container can be read from several threads at once.
+         * @tparam Iterator The iterator class of the traversal.
+         */
+        template <typename Iterator>
+        class Range
+        {
+            Iterator first;
+            Iterator last;
+
+        public:
+            Range(Iterator first, Iterator last) : first(first), last(last) {}
+
+            Iterator begin() const { return first; }
+            Iterator end() const { return last; }
+
+            /**
+             * @brief Get the number of elements in the range, in O(1).
+             */
+            size_t size() const { return last.position() - first.position(); }
+            bool empty() const { return size() == 0; }
+
+            /**
+             * @brief Split the range into n consecutive sub-ranges whose sizes differ by at most one.
+             * @details Each sub-range has its own iterators, placed with operator+= in O(1),
+             * so the split costs O(n) whatever the size of the range.
+             * @param parts The number of sub-ranges; some are empty when it exceeds size().
+             * @return The sub-ranges in traversal order.
+             * @throws std::invalid_argument if parts is 0.
+             */
+            std::vector<Range> split(size_t parts) const
+            {
+                if (parts == 0)
+                    throw std::invalid_argument("Cant split a range into 0 parts");
+                std::vector<Range> ranges;
+                ranges.reserve(parts);
+                size_t total = size();
+                Iterator cursor = first;
+                for (size_t i = 0; i < parts; ++i)
+                {
+                    Iterator start = cursor;
+                    cursor += total / parts + (i < total % parts ? 1 : 0);
+                    ranges.emplace_back(start, cursor);
+                }
+                return ranges;
+            }
+        };
+
         /**
          * @class AscendingIterator
          * @brief An iterator that traverses the container in ascending order.
@@ -216,7 +725,7 @@ namespace ariel
              * @brief Constructs a new AscendingIterator object.
              * @param magicalContainer The MagicalContainer to iterate over.
              */
-            AscendingIterator(MagicalContainer &magicalContainer);
+            AscendingIterator(BasicMagicalContainer &magicalContainer);
 
             /**
              * @brief Copy constructor for AscendingIterator.
@@ -235,7 +744,7 @@ namespace ariel
              * @brief Dereference operator for AscendingIterator.
              * @return The value pointed to by the iterator.
              */
-            int operator*() const;
+            T operator*() const;
 
             /**
              * @brief Pre-increment operator for AscendingIterator.
@@ -243,6 +752,20 @@ namespace ariel
              */
             AscendingIterator &operator++();
 
+            /**
+             * @brief Advance the iterator by `steps` elements in O(1).
+             * @return Reference to the advanced AscendingIterator object.
+             * @throws std::runtime_error if that goes past the end.
+             */
+            AscendingIterator &operator+=(size_t steps);
+
+            /**
+             * @brief Copy the next values into out and advance past them, checking the bounds once per batch.
+             * @param out The buffer to fill.
+             * @return The number of values written, less than out.size() only at the end of the traversal.
+             */
+            size_t fetchBatch(std::span<T> out);
+
             /**
              * @brief Get the beginning iterator of the container.
              * @return An AscendingIterator object representing the beginning of the container.
@@ -254,11 +777,78 @@ namespace ariel
              * @return An AscendingIterator object representing the end of the container.
              */
             AscendingIterator end();
+
+            /**
+             * @brief Split the traversal from begin() to end() into balanced sub-ranges.
+             * @param parts The number of sub-ranges.
+             * @return The sub-ranges in traversal order, see Range::split.
+             * @throws std::invalid_argument if parts is 0.
+             */
+            std::vector<Range<AscendingIterator>> split(size_t parts);
+
+            /**
+             * @brief Get an iterator at the first element that is not less than value, in O(log n).
+             * @param value The value to search for.
+             * @return An AscendingIterator at that element, or end() if every element is less.
+             */
+            AscendingIterator lowerBound(T value) const;
+
+            /**
+             * @brief Get an iterator at the first element that is greater than value, in O(log n).
+             * @param value The value to search for.
+             * @return An AscendingIterator at that element, or end() if no element is greater.
+             */
+            AscendingIterator upperBound(T value) const;
+
+            /**
+             * @brief Get the iterators around all the elements equal to value, in O(log n).
+             * @param value The value to search for.
+             * @return The pair {lowerBound(value), upperBound(value)}.
+             */
+            std::pair<AscendingIterator, AscendingIterator> equalRange(T value) const;
         };
+
+        /**
+         * @brief The elements in [low, high) of the ascending view, found by binary search.
+         */
+        using AscendingRange = Range<AscendingIterator>;
+
+        /**
+         * @brief Get the elements in [low, high) in ascending order.
+         * @param low The smallest value included.
+         * @param high The first value excluded.
+         * @return The range, empty when high <= low.
+         */
+        AscendingRange range(T low, T high);
+
+        /**
+         * @brief Get a lazy sequence of the elements in ascending order.
+         * @details Each element is produced when it is read, so reading k elements costs O(k).
+         * The sequence keeps reading the elements as they were when it was created: a later
+         * mutation of the container copies the storage instead of changing it.
+         */
+        Generator<T> ascending() const;
+
+        /**
+         * @brief Get a lazy sequence of the elements not less than low, in ascending order.
+         * @details Starts with a binary search, then costs O(1) per element read.
+         * @param low The smallest value included.
+         */
+        Generator<T> ascendingFrom(T low) const;
+
+        /**
+         * @brief Get a lazy sequence of the elements in side-cross order.
+         */
+        Generator<T> sideCross() const;
+
+        /**
+         * @brief Get a lazy sequence of the prime elements in insertion order.
+         */
+        Generator<T> primes() const;
         // Helper functions declarations
-        void initCross(std::vector<int *> &cross);
-        void updateFromStart(std::vector<int *>::iterator &start_it, std::vector<int *> &cross);
-        void updateFromEnd(std::vector<int *>::reverse_iterator &end_it, std::vector<int *> &cross);
+        void initCross(std::pmr::vector<index_type> &cross);
+        void updateFromStart(const index_type *&start_it, std::pmr::vector<index_type> &cross);
+        void updateFromEnd(std::reverse_iterator<const index_type *> &end_it, std::pmr::vector<index_type> &cross);
 
         /**
          * @class SideCrossIterator
@@ -267,13 +857,11 @@ namespace ariel
         class SideCrossIterator : public BasicIterator
         {
         public:
-            void optimise_sort();
-            void optimise_prime();
             /**
              * @brief Constructs a new SideCrossIterator object.
              * @param magicalContainer The MagicalContainer to iterate over.
              */
-            SideCrossIterator(MagicalContainer &magicalContainer);
+            SideCrossIterator(BasicMagicalContainer &magicalContainer);
 
             /**
              * @brief Copy constructor for SideCrossIterator.
@@ -292,7 +880,7 @@ namespace ariel
              * @brief Dereference operator for SideCrossIterator.
              * @return The value pointed to by the iterator.
              */
-            int operator*() const;
+            T operator*() const;
 
             /**
              * @brief Pre-increment operator for SideCrossIterator.
@@ -300,6 +888,20 @@ namespace ariel
              */
             SideCrossIterator &operator++();
 
+            /**
+             * @brief Advance the iterator by `steps` elements in O(1).
+             * @return Reference to the advanced SideCrossIterator object.
+             * @throws std::runtime_error if that goes past the end.
+             */
+            SideCrossIterator &operator+=(size_t steps);
+
+            /**
+             * @brief Copy the next values into out and advance past them, checking the bounds once per batch.
+             * @param out The buffer to fill.
+             * @return The number of values written, less than out.size() only at the end of the traversal.
+             */
+            size_t fetchBatch(std::span<T> out);
+
             /**
              * @brief Get the beginning iterator of the container.
              * @return A SideCrossIterator object representing the beginning of the container.
@@ -311,6 +913,14 @@ namespace ariel
              * @return A SideCrossIterator object representing the end of the container.
              */
             SideCrossIterator end();
+
+            /**
+             * @brief Split the traversal from begin() to end() into balanced sub-ranges.
+             * @param parts The number of sub-ranges.
+             * @return The sub-ranges in traversal order, see Range::split.
+             * @throws std::invalid_argument if parts is 0.
+             */
+            std::vector<Range<SideCrossIterator>> split(size_t parts);
         };
 
         /**
@@ -327,7 +937,7 @@ namespace ariel
              * @brief Constructs a new PrimeIterator object.
              * @param magicalContainer The MagicalContainer to iterate over.
              */
-            PrimeIterator(MagicalContainer &magicalContainer);
+            PrimeIterator(BasicMagicalContainer &magicalContainer);
 
             /**
              * @brief Copy constructor for PrimeIterator.
@@ -346,7 +956,7 @@ namespace ariel
              * @brief Dereference operator for PrimeIterator.
              * @return The value pointed to by the iterator.
              */
-            int operator*() const;
+            T operator*() const;
 
             /**
              * @brief Pre-increment operator for PrimeIterator.
@@ -354,6 +964,20 @@ namespace ariel
              */
             PrimeIterator &operator++();
 
+            /**
+             * @brief Advance the iterator by `steps` elements in O(1).
+             * @return Reference to the advanced PrimeIterator object.
+             * @throws std::runtime_error if that goes past the end.
+             */
+            PrimeIterator &operator+=(size_t steps);
+
+            /**
+             * @brief Copy the next values into out and advance past them, checking the bounds once per batch.
+             * @param out The buffer to fill.
+             * @return The number of values written, less than out.size() only at the end of the traversal.
+             */
+            size_t fetchBatch(std::span<T> out);
+
             /**
              * @brief Get the beginning iterator of the container.
              * @return A PrimeIterator object representing the beginning of the container.
@@ -365,6 +989,153 @@ namespace ariel
              * @return A PrimeIterator object representing the end of the container.
              */
             PrimeIterator end();
+
+            /**
+             * @brief Split the traversal from begin() to end() into balanced sub-ranges.
+             * @param parts The number of sub-ranges.
+             * @return The sub-ranges in traversal order, see Range::split.
+             * @throws std::invalid_argument if parts is 0.
+             */
+            std::vector<Range<PrimeIterator>> split(size_t parts);
+        };
+
+        /**
+         * @class ViewIterator
+         * @brief An iterator over a user-defined view.
+         * @tparam View A Filter<Predicate> or Order<Compare> of this container.
+         */
+        template <typename View>
+        class ViewIterator : public BasicIterator
+        {
+            size_t slot;
+
+            const View &target() const
+            {
+                return this->magicalContainer->template viewAt<View>(slot);
+            }
+
+        public:
+            /**
+             * @brief Constructs a new ViewIterator object, registering the view if needed.
+             * @param magicalContainer The MagicalContainer to iterate over.
+             */
+            ViewIterator(BasicMagicalContainer &magicalContainer)
+                : BasicIterator(magicalContainer), slot(magicalContainer.template viewSlot<View>()) {}
+
+            /**
+             * @brief Dereference operator for ViewIterator.
+             * @return The value pointed to by the iterator.
+             */
+            T operator*() const
+            {
+                const View &view = target();
+                if (this->pos >= view.size())
+                    throw std::runtime_error("Iterator is out of range");
+                return this->magicalContainer->data->regular[view[this->pos]];
+            }
+
+            /**
+             * @brief Pre-increment operator for ViewIterator.
+             * @return Reference to the incremented ViewIterator object.
+             */
+            ViewIterator &operator++()
+            {
+                if (this->pos >= target().size())
+                    throw std::runtime_error("Iterator is out of range");
+                ++this->pos;
+                return *this;
+            }
+
+            /**
+             * @brief Advance the iterator by `steps` elements in O(1).
+             * @return Reference to the advanced ViewIterator object.
+             * @throws std::runtime_error if that goes past the end.
+             */
+            ViewIterator &operator+=(size_t steps)
+            {
+                this->advance(steps, target().size());
+                return *this;
+            }
+
+            /**
+             * @brief Copy the next values into out and advance past them, checking the bounds once per batch.
+             * @param out The buffer to fill.
+             * @return The number of values written, less than out.size() only at the end of the view.
+             */
+            size_t fetchBatch(std::span<T> out)
+            {
+                return this->gather(target().data(), out);
+            }
+
+            /**
+             * @brief Get the beginning iterator of the view.
+             * @return A ViewIterator object representing the beginning of the view.
+             */
+            ViewIterator begin() const
+            {
+                ViewIterator temp(*this);
+                temp.pos = 0;
+                return temp;
+            }
+
+            /**
+             * @brief Get the ending iterator of the view.
+             * @return A ViewIterator object representing the end of the view.
+             */
+            ViewIterator end() const
+            {
+                ViewIterator temp(*this);
+                temp.pos = target().size();
+                return temp;
+            }
+
+            /**
+             * @brief Split the traversal from begin() to end() into balanced sub-ranges.
+             * @param parts The number of sub-ranges.
+             * @return The sub-ranges in traversal order, see Range::split.
+             * @throws std::invalid_argument if parts is 0.
+             */
+            std::vector<Range<ViewIterator>> split(size_t parts) const
+            {
+                return Range<ViewIterator>(begin(), end()).split(parts);
+            }
         };
+
+        /**
+         * @brief An iterator over the elements accepted by Predicate, in insertion order.
+         */
+        template <typename Predicate>
+        using FilterIterator = ViewIterator<Filter<Predicate>>;
+
+        /**
+         * @brief An iterator over all the elements in the order given by Compare.
+         */
+        template <typename Compare>
+        using OrderIterator = ViewIterator<Order<Compare>>;
     };
+
+    extern template class BasicMagicalContainer<int>;
+    extern template class BasicMagicalContainer<std::uint32_t>;
+    extern template class BasicMagicalContainer<std::int64_t>;
+    extern template class BasicMagicalContainer<std::uint64_t>;
+    extern template class BasicMagicalContainer<std::int64_t, WideElementTraits<std::int64_t>>;
+    extern template class BasicMagicalContainer<std::uint64_t, WideElementTraits<std::uint64_t>>;
+    extern template class BasicMagicalContainer<int, CompactElementTraits<int>>;
+
+    /**
+     * @brief The container of `int` elements.
+     */
+    using MagicalContainer = BasicMagicalContainer<int>;
+
+    /**
+     * @brief A container with 64-bit view indices, for more than 2^32 - 1 elements.
+     */
+    template <typename T>
+    using WideMagicalContainer = BasicMagicalContainer<T, WideElementTraits<T>>;
+
+    /**
+     * @brief A container with 16-bit view indices, for at most 2^16 - 1 elements.
+     */
+    template <typename T>
+    using CompactMagicalContainer = BasicMagicalContainer<T, CompactElementTraits<T>>;
 }
@@ -0,0 +1,160 @@
+/**
+ * @file Parallel.hpp
+ * @brief Parallel traversal of the MagicalContainer views.
+ * @details The views are position based, so a traversal of n elements is split into
+ * contiguous chunks with split(), each one placed with operator+= in O(1), and each task
+ * reads its chunk with fetchBatch. The chunks run on a
+ * work-stealing ThreadPool, a few chunks per thread so that uneven work is balanced.
+ * The container must not be modified while a parallel traversal runs.
+ *
+ * @author Maya Rom
+ * @ID 207485251
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <functional>
+#include <optional>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "ThreadPool.hpp"
+
+namespace ariel
+{
+    /**
+     * @brief Smallest number of elements worth a task of its own.
+     */
+    constexpr size_t parallel_grain = 4096;
+
+    /**
+     * @brief Get the number of chunks to split `total` elements into for the threads of `pool`.
+     */
+    inline size_t parallelChunks(size_t total, const ThreadPool &pool)
+    {
+        return std::min(pool.concurrency() * 4, std::max<size_t>(total / parallel_grain, 1));
+    }
+
+    /**
+     * @brief Read `count` elements of a view from `it` on with fetchBatch and pass each one to fn.
+     */
+    template <typename Iterator, typename Fn>
+    void forEachFrom(Iterator it, size_t count, Fn &fn)
+    {
+        using value_type = std::remove_cvref_t<decltype(*it)>;
+        std::array<value_type, 1024> buffer;
+        for (size_t remaining = count; remaining > 0;)
+        {
+            size_t read = it.fetchBatch(std::span<value_type>(buffer.data(), std::min(buffer.size(), remaining)));
+            for (size_t i = 0; i < read; ++i)
+                fn(buffer[i]);
+            remaining -= read;
+        }
+    }
+
+    /**
+     * @brief Pass every element of a view, from begin() to end(), to fn.
+     */
+    template <typename Iterator, typename Fn>
+    void forEachInView(Iterator view, Fn &fn)
+    {
+        forEachFrom(view.begin(), view.end().position(), fn);
+    }
+
+    /**
+     * @brief Fold `count` elements of a view from `it` on, starting from the first of them.
+     * @return The folded value, or nothing when count is 0.
+     */
+    template <typename Result, typename Iterator, typename Op>
+    std::optional<Result> foldFrom(Iterator it, size_t count, Op &op)
+    {
+        std::optional<Result> partial;
+        auto fold = [&](const auto &value)
+        {
+            if (partial)
+                partial = op(std::move(*partial), value);
+            else
+                partial.emplace(value);
+        };
+        forEachFrom(std::move(it), count, fold);
+        return partial;
+    }
+
+    /**
+     * @brief Fold every element of a view, from begin() to end(), starting from the first of them.
+     * @return The folded value, or nothing when the view is empty.
+     */
+    template <typename Result, typename Iterator, typename Op>
+    std::optional<Result> foldView(Iterator view, Op &op)
+    {
+        return foldFrom<Result>(view.begin(), view.end().position(), op);
+    }
+
+    /**
+     * @brief Fold the partial results of consecutive chunks, in chunk order, from init.
+     */
+    template <typename Result, typename Op>
+    Result foldPartials(Result init, std::vector<std::optional<Result>> &partials, Op &op)
+    {
+        for (auto &partial : partials)
+        {
+            if (partial)
+                init = op(std::move(init), std::move(*partial));
+        }
+        return init;
+    }
+
+    /**
+     * @brief Call fn on every element of a view, from several threads.
+     * @details fn is called concurrently and in no particular order; it must be safe to call
+     * from several threads at once.
+     * @param view An iterator of the view to traverse; the traversal starts at view.begin().
+     * @param fn The function called with each element.
+     * @param pool The thread pool to run on.
+     * @throws The first exception thrown by fn, once all the chunks have stopped.
+     */
+    template <typename Iterator, typename Fn>
+    void parallelForEach(Iterator view, Fn fn, ThreadPool &pool = ThreadPool::shared())
+    {
+        auto ranges = view.split(parallelChunks(view.end().position(), pool));
+        std::vector<std::function<void()>> tasks;
+        tasks.reserve(ranges.size());
+        for (const auto &range : ranges)
+            tasks.emplace_back([&]
+                               { forEachFrom(range.begin(), range.size(), fn); });
+        pool.run(std::move(tasks));
+    }
+
+    /**
+     * @brief Fold the elements of a view, from several threads.
+     * @details Every chunk of the traversal is folded separately, starting from the value of
+     * the first element of the chunk, and the partial results are then folded from `init` in
+     * the order of the chunks with op(accumulated, partial). op must therefore be associative;
+     * it need not be commutative. Result must be constructible from an element.
+     * @param view An iterator of the view to traverse; the traversal starts at view.begin().
+     * @param init The initial value.
+     * @param op The binary operation, called as op(accumulated, element).
+     * @param pool The thread pool to run on.
+     * @return init folded with every element in traversal order, up to associativity.
+     * @throws The first exception thrown by op, once all the chunks have stopped.
+     */
+    template <typename Iterator, typename Result, typename Op>
+    Result parallelReduce(Iterator view, Result init, Op op, ThreadPool &pool = ThreadPool::shared())
+    {
+        auto ranges = view.split(parallelChunks(view.end().position(), pool));
+        size_t chunks = ranges.size();
+        std::vector<std::optional<Result>> partials(chunks);
+        std::vector<std::function<void()>> tasks;
+        tasks.reserve(chunks);
+        for (size_t i = 0; i < chunks; ++i)
+            tasks.emplace_back([&, i]
+                               { partials[i] = foldFrom<Result>(ranges[i].begin(), ranges[i].size(), op); });
+        pool.run(std::move(tasks));
+        return foldPartials(std::move(init), partials, op);
+    }
+}
@@ -0,0 +1,205 @@
+#include "RangeShardedContainer.hpp"
+#include <algorithm>
+
+using namespace ariel;
+using namespace std;
+
+// One shard per range
+template <typename T>
+BasicRangeShardedContainer<T>::BasicRangeShardedContainer(std::span<const T> boundaries, std::pmr::memory_resource *resource)
+    : boundaries(boundaries.begin(), boundaries.end())
+{
+    if (std::adjacent_find(boundaries.begin(), boundaries.end(), std::greater_equal<T>()) != boundaries.end())
+        throw std::invalid_argument("Shard boundaries must be strictly ascending");
+    shardList.reserve(boundaries.size() + 1);
+    for (size_t i = 0; i <= boundaries.size(); ++i)
+        shardList.push_back(std::make_unique<Shard>(resource));
+}
+
+// Boundaries of equal-width ranges
+template <typename T>
+std::vector<T> BasicRangeShardedContainer<T>::evenBoundaries(size_t shards, T low, T high)
+{
+    if (shards == 0)
+        throw std::invalid_argument("A sharded container needs at least one shard");
+    if (high < low)
+        throw std::invalid_argument("The value range is empty");
+
+    // the width is computed in the unsigned type, so a range over the whole type does not overflow
+    using unsigned_type = typename ElementTraits<T>::unsigned_type;
+    auto width = static_cast<unsigned_type>(static_cast<unsigned_type>(high) - static_cast<unsigned_type>(low));
+    if (width < shards - 1)
+        throw std::invalid_argument("The value range holds fewer values than shards");
+
+    // boundary i is low + floor(width * i / shards) + 1, strictly ascending since width + 1 >= shards
+    std::vector<T> boundaries;
+    boundaries.reserve(shards - 1);
+    for (size_t i = 1; i < shards; ++i)
+    {
+        auto step = static_cast<unsigned_type>(width / shards * i + width % shards * i / shards);
+        boundaries.push_back(static_cast<T>(static_cast<unsigned_type>(static_cast<unsigned_type>(low) + step + 1)));
+    }
+    return boundaries;
+}
+
+// Shard of a value: the number of boundaries not greater than it
+template <typename T>
+size_t BasicRangeShardedContainer<T>::shardOf(T value) const
+{
+    return static_cast<size_t>(std::upper_bound(boundaries.begin(), boundaries.end(), value) - boundaries.begin());
+}
+
+// Add to one shard under its lock
+template <typename T>
+void BasicRangeShardedContainer<T>::addElement(T element)
+{
+    Shard &target = *shardList[shardOf(element)];
+    std::lock_guard<std::mutex> lock(target.mutex);
+    target.container.addElement(element);
+}
+
+// Partition by shard, then one bulk insert per shard
+template <typename T>
+void BasicRangeShardedContainer<T>::addElements(std::span<const T> elements)
+{
+    std::vector<std::vector<T>> parts(shardList.size());
+    for (T element : elements)
+        parts[shardOf(element)].push_back(element);
+    for (size_t i = 0; i < parts.size(); ++i)
+    {
+        if (parts[i].empty())
+            continue;
+        std::lock_guard<std::mutex> lock(shardList[i]->mutex);
+        shardList[i]->container.addElements(parts[i]);
+    }
+}
+
+// Remove from one shard under its lock
+template <typename T>
+void BasicRangeShardedContainer<T>::removeElement(T element)
+{
+    Shard &target = *shardList[shardOf(element)];
+    std::lock_guard<std::mutex> lock(target.mutex);
+    target.container.removeElement(element);
+}
+
+// Total size over the shards
+template <typename T>
+size_t BasicRangeShardedContainer<T>::size() const
+{
+    size_t total = 0;
+    for (const auto &entry : shardList)
+    {
+        std::lock_guard<std::mutex> lock(entry->mutex);
+        total += entry->container.size();
+    }
+    return total;
+}
+
+// Direct access to a shard
+template <typename T>
+typename BasicRangeShardedContainer<T>::container_type &BasicRangeShardedContainer<T>::shard(size_t index)
+{
+    if (index >= shardList.size())
+        throw std::out_of_range("No such shard");
+    return shardList[index]->container;
+}
+
+// BasicIterator equality comparison operator
+template <typename T>
+bool BasicRangeShardedContainer<T>::BasicIterator::operator==(const BasicIterator &other) const
+{
+    if (container != other.container)
+        throw std::invalid_argument("Cant compare iterators from different containers");
+    return pos == other.pos;
+}
+
+// BasicIterator inequality comparison operator
+template <typename T>
+bool BasicRangeShardedContainer<T>::BasicIterator::operator!=(const BasicIterator &other) const
+{
+    return !(*this == other);
+}
+
+// BasicIterator greater than comparison operator
+template <typename T>
+bool BasicRangeShardedContainer<T>::BasicIterator::operator>(const BasicIterator &other) const
+{
+    if (container != other.container)
+        throw std::invalid_argument("Cant compare iterators from different containers");
+    return pos > other.pos;
+}
+
+// BasicIterator less than comparison operator
+template <typename T>
+bool BasicRangeShardedContainer<T>::BasicIterator::operator<(const BasicIterator &other) const
+{
+    if (container != other.container)
+        throw std::invalid_argument("Cant compare iterators from different containers");
+    return pos < other.pos;
+}
+
+// AscendingIterator constructor, at the smallest element
+template <typename T>
+BasicRangeShardedContainer<T>::AscendingIterator::AscendingIterator(BasicRangeShardedContainer &container)
+    : BasicIterator(container)
+{
+    skipEmpty();
+}
+
+// Move past exhausted shards
+template <typename T>
+void BasicRangeShardedContainer<T>::AscendingIterator::skipEmpty()
+{
+    const auto &shards = this->container->shardList;
+    while (current < shards.size() && offset == shards[current]->container.size())
+    {
+        ++current;
+        offset = 0;
+    }
+}
+
+// Dereference operator for AscendingIterator
+template <typename T>
+T BasicRangeShardedContainer<T>::AscendingIterator::operator*() const
+{
+    if (current >= this->container->shardList.size())
+        throw std::runtime_error("Iterator is out of range");
+    return this->container->shardList[current]->container.kthSmallest(offset);
+}
+
+// Pre-increment operator for AscendingIterator
+template <typename T>
+typename BasicRangeShardedContainer<T>::AscendingIterator &BasicRangeShardedContainer<T>::AscendingIterator::operator++()
+{
+    if (current >= this->container->shardList.size())
+        throw std::runtime_error("Iterator is out of range");
+    ++offset;
+    ++this->pos;
+    skipEmpty();
+    return *this;
+}
+
+// Begin function for AscendingIterator
+template <typename T>
+typename BasicRangeShardedContainer<T>::AscendingIterator BasicRangeShardedContainer<T>::AscendingIterator::begin() const
+{
+    return AscendingIterator(*this->container);
+}
+
+// End function for AscendingIterator
+template <typename T>
+typename BasicRangeShardedContainer<T>::AscendingIterator BasicRangeShardedContainer<T>::AscendingIterator::end() const
+{
+    AscendingIterator temp(*this->container);
+    temp.current = this->container->shardList.size();
+    temp.offset = 0;
+    temp.pos = this->container->size();
+    return temp;
+}
+
+// The element types the container is compiled for
+template class ariel::BasicRangeShardedContainer<int>;
+template class ariel::BasicRangeShardedContainer<std::uint32_t>;
+template class ariel::BasicRangeShardedContainer<std::int64_t>;
+template class ariel::BasicRangeShardedContainer<std::uint64_t>;
@@ -0,0 +1,239 @@
+/**
+ * @file RangeShardedContainer.hpp
+ * @brief Defines a MagicalContainer split into shards by value range.
+ * @details BasicRangeShardedContainer partitions the values into K consecutive key ranges
+ * given by K - 1 ascending boundaries; shard i holds the values in [boundary[i - 1], boundary[i]).
+ * Every shard is an independent MagicalContainer with its own lock, so inserts into different
+ * shards never contend. Because the ranges are ordered, the ascending order of the whole
+ * container is the concatenation of the ascending views of the shards, with no merge, and a
+ * parallel ascending scan runs one shard per thread.
+ * The side-cross and prime orders of the whole container are not kept; they are available
+ * per shard through shard(i).
+ *
+ * @author Maya Rom
+ * @ID 207485251
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+#include "MagicalContainer.hpp"
+#include "Parallel.hpp"
+
+namespace ariel
+{
+    /**
+     * @class BasicRangeShardedContainer
+     * @brief K MagicalContainer shards over consecutive value ranges.
+     * @tparam T The integer element type.
+     */
+    template <typename T>
+    class BasicRangeShardedContainer
+    {
+    public:
+        using value_type = T;
+        using container_type = BasicMagicalContainer<T>;
+
+    private:
+        /**
+         * @brief One shard and the lock of its writers, on its own cache lines.
+         */
+        struct alignas(64) Shard
+        {
+            std::mutex mutex;
+            container_type container;
+
+            explicit Shard(std::pmr::memory_resource *resource) : container(resource) {}
+        };
+
+        std::vector<T> boundaries; // the first value of every shard but the first
+        std::vector<std::unique_ptr<Shard>> shardList;
+
+        /**
+         * @class BasicIterator
+         * @brief Base class for the iterator classes of RangeShardedContainer.
+         */
+        class BasicIterator
+        {
+        protected:
+            BasicRangeShardedContainer *container;
+            size_t pos;
+
+        public:
+            BasicIterator(BasicRangeShardedContainer &container) : container(&container), pos(0) {}
+
+            /**
+             * @brief Equality operator for BasicIterator.
+             * @throws std::invalid_argument if the iterators belong to different containers.
+             */
+            bool operator==(const BasicIterator &other) const;
+
+            /**
+             * @brief Inequality operator for BasicIterator.
+             * @throws std::invalid_argument if the iterators belong to different containers.
+             */
+            bool operator!=(const BasicIterator &other) const;
+
+            /**
+             * @brief Greater than operator for BasicIterator.
+             * @throws std::invalid_argument if the iterators belong to different containers.
+             */
+            bool operator>(const BasicIterator &other) const;
+
+            /**
+             * @brief Less than operator for BasicIterator.
+             * @throws std::invalid_argument if the iterators belong to different containers.
+             */
+            bool operator<(const BasicIterator &other) const;
+        };
+
+    public:
+        /**
+         * @brief Constructs an empty container with boundaries.size() + 1 shards.
+         * @param boundaries The first value of every shard but the first, strictly ascending.
+         * @param resource The memory resource of the shards (must outlive the container).
+         * @throws std::invalid_argument if the boundaries are not strictly ascending.
+         */
+        explicit BasicRangeShardedContainer(std::span<const T> boundaries,
+                                            std::pmr::memory_resource *resource = std::pmr::get_default_resource());
+
+        /**
+         * @brief Get boundaries splitting [low, high] into `shards` ranges whose widths differ by at most one.
+         * @return shards - 1 strictly ascending boundaries.
+         * @throws std::invalid_argument if shards is 0, high < low, or [low, high] holds fewer than `shards` values.
+         */
+        static std::vector<T> evenBoundaries(size_t shards, T low, T high);
+
+        /**
+         * @brief Add an element to its shard, locking only that shard.
+         * @param element The element to add.
+         */
+        void addElement(T element);
+
+        /**
+         * @brief Add many elements, one bulk insert per shard.
+         * @param elements The elements to add.
+         */
+        void addElements(std::span<const T> elements);
+
+        /**
+         * @brief Remove an element from its shard, locking only that shard.
+         * @param element The element to remove.
+         * @throws std::runtime_error if the element is not in the container.
+         */
+        void removeElement(T element);
+
+        /**
+         * @brief Get the number of elements in all the shards.
+         */
+        size_t size() const;
+
+        /**
+         * @brief Get the number of shards.
+         */
+        size_t shards() const { return shardList.size(); }
+
+        /**
+         * @brief Get the index of the shard that holds a value, in O(log K).
+         */
+        size_t shardOf(T value) const;
+
+        /**
+         * @brief Get a shard; its views hold the values of one range.
+         * @note Access through this reference is not locked.
+         */
+        container_type &shard(size_t index);
+
+        /**
+         * @class AscendingIterator
+         * @brief The elements in ascending order, reading the shards one after another.
+         * @note The shards must not be modified while the iterator is used.
+         */
+        class AscendingIterator : public BasicIterator
+        {
+            size_t current = 0; // the shard of the element at pos
+            size_t offset = 0;  // its rank within that shard
+
+            void skipEmpty();
+
+        public:
+            AscendingIterator(BasicRangeShardedContainer &container);
+
+            /**
+             * @brief Dereference operator for AscendingIterator.
+             * @throws std::runtime_error if the iterator is at the end.
+             */
+            T operator*() const;
+
+            /**
+             * @brief Pre-increment operator for AscendingIterator.
+             * @throws std::runtime_error if the iterator is at the end.
+             */
+            AscendingIterator &operator++();
+
+            AscendingIterator begin() const;
+            AscendingIterator end() const;
+        };
+    };
+
+    /**
+     * @brief Call fn on every element of a sharded container, one shard per task.
+     * @details fn is called concurrently and in no particular order. The shards must not be
+     * modified while the scan runs.
+     * @throws The first exception thrown by fn, once all the shards have stopped.
+     */
+    template <typename T, typename Fn>
+    void parallelForEach(BasicRangeShardedContainer<T> &container, Fn fn, ThreadPool &pool = ThreadPool::shared())
+    {
+        std::vector<std::function<void()>> tasks;
+        tasks.reserve(container.shards());
+        for (size_t i = 0; i < container.shards(); ++i)
+            tasks.emplace_back([&, i]
+                               {
+                                   typename BasicMagicalContainer<T>::AscendingIterator ascending(container.shard(i));
+                                   forEachInView(ascending, fn); });
+        pool.run(std::move(tasks));
+    }
+
+    /**
+     * @brief Fold the elements of a sharded container in ascending order, one shard per task.
+     * @details Each shard is folded separately and the partial results are folded from init
+     * in shard order, so op must be associative but need not be commutative, as for
+     * parallelReduce over a view.
+     * @throws The first exception thrown by op, once all the shards have stopped.
+     */
+    template <typename T, typename Result, typename Op>
+    Result parallelReduce(BasicRangeShardedContainer<T> &container, Result init, Op op, ThreadPool &pool = ThreadPool::shared())
+    {
+        std::vector<std::optional<Result>> partials(container.shards());
+        std::vector<std::function<void()>> tasks;
+        tasks.reserve(container.shards());
+        for (size_t i = 0; i < container.shards(); ++i)
+            tasks.emplace_back([&, i]
+                               {
+                                   typename BasicMagicalContainer<T>::AscendingIterator ascending(container.shard(i));
+                                   partials[i] = foldView<Result>(ascending, op); });
+        pool.run(std::move(tasks));
+        return foldPartials(std::move(init), partials, op);
+    }
+
+    extern template class BasicRangeShardedContainer<int>;
+    extern template class BasicRangeShardedContainer<std::uint32_t>;
+    extern template class BasicRangeShardedContainer<std::int64_t>;
+    extern template class BasicRangeShardedContainer<std::uint64_t>;
+
+    /**
+     * @brief The range-sharded container of `int` elements.
+     */
+    using RangeShardedContainer = BasicRangeShardedContainer<int>;
+}
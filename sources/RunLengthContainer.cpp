@@ -0,0 +1,421 @@
+#include "RunLengthContainer.hpp"
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+using namespace ariel;
+using namespace std;
+
+namespace
+{
+    // Smallest code width in bytes that can number `entries` dictionary entries
+    unsigned widthFor(size_t entries)
+    {
+        if (entries <= (size_t(1) << 8U))
+            return 1;
+        if (entries <= (size_t(1) << 16U))
+            return 2;
+        return 4;
+    }
+}
+
+// Constructor
+template <typename T>
+BasicRunLengthContainer<T>::BasicRunLengthContainer(std::pmr::memory_resource *resource)
+    : values(resource), counts(resource), primes(resource), ascending(resource), codes(resource) {}
+
+// Read the packed code of the element at pos
+template <typename T>
+typename BasicRunLengthContainer<T>::code_type BasicRunLengthContainer<T>::codeAt(size_t pos) const
+{
+    const std::uint8_t *at = codes.data() + pos * codeWidth;
+    switch (codeWidth)
+    {
+    case 1:
+        return *at;
+    case 2:
+    {
+        std::uint16_t code = 0;
+        std::memcpy(&code, at, sizeof(code));
+        return code;
+    }
+    default:
+    {
+        code_type code = 0;
+        std::memcpy(&code, at, sizeof(code));
+        return code;
+    }
+    }
+}
+
+// Append a packed code
+template <typename T>
+void BasicRunLengthContainer<T>::pushCode(code_type code)
+{
+    codes.resize(codes.size() + codeWidth);
+    std::uint8_t *at = codes.data() + codes.size() - codeWidth;
+    switch (codeWidth)
+    {
+    case 1:
+        *at = static_cast<std::uint8_t>(code);
+        break;
+    case 2:
+    {
+        auto narrow = static_cast<std::uint16_t>(code);
+        std::memcpy(at, &narrow, sizeof(narrow));
+        break;
+    }
+    default:
+        std::memcpy(at, &code, sizeof(code));
+        break;
+    }
+}
+
+// Rewrite every packed code through a code map
+template <typename T>
+void BasicRunLengthContainer<T>::recode(const std::vector<code_type> &remap, unsigned width)
+{
+    std::vector<code_type> decoded(elementCount);
+    for (size_t pos = 0; pos < elementCount; ++pos)
+        decoded[pos] = codeAt(pos);
+    codes.clear();
+    codeWidth = width;
+    codes.reserve(elementCount * width);
+    for (code_type code : decoded)
+        pushCode(remap.empty() ? code : remap[code]);
+}
+
+// Drop the vacant dictionary entries
+template <typename T>
+void BasicRunLengthContainer<T>::compact()
+{
+    std::vector<code_type> remap(values.size());
+    size_t kept = 0;
+    for (size_t code = 0; code < values.size(); ++code)
+    {
+        if (counts[code] == 0)
+            continue;
+        remap[code] = static_cast<code_type>(kept);
+        values[kept] = values[code];
+        counts[kept] = counts[code];
+        primes[kept] = primes[code];
+        ++kept;
+    }
+    values.resize(kept);
+    counts.resize(kept);
+    primes.resize(kept);
+    for (code_type &code : ascending)
+        code = remap[code];
+    vacant = 0;
+    recode(remap, widthFor(kept));
+}
+
+// First run whose value is >= value
+template <typename T>
+size_t BasicRunLengthContainer<T>::findRun(T value) const
+{
+    auto it = std::partition_point(ascending.begin(), ascending.end(), [this, value](code_type code)
+                                   { return values[code] < value; });
+    return static_cast<size_t>(it - ascending.begin());
+}
+
+// Step a cursor to the next occurrence in ascending order
+template <typename T>
+void BasicRunLengthContainer<T>::forward(Cursor &cursor) const
+{
+    if (++cursor.offset == counts[ascending[cursor.run]])
+    {
+        ++cursor.run;
+        cursor.offset = 0;
+    }
+}
+
+// Step a cursor to the previous occurrence in ascending order
+template <typename T>
+void BasicRunLengthContainer<T>::backward(Cursor &cursor) const
+{
+    if (cursor.offset == 0)
+    {
+        --cursor.run;
+        cursor.offset = counts[ascending[cursor.run]] - 1;
+    }
+    else
+    {
+        --cursor.offset;
+    }
+}
+
+// Add an element to the container
+template <typename T>
+void BasicRunLengthContainer<T>::addElement(T element)
+{
+    size_t run = findRun(element);
+    if (run < ascending.size() && values[ascending[run]] == element)
+    {
+        code_type code = ascending[run];
+        ++counts[code];
+        pushCode(code);
+        ++elementCount;
+        return;
+    }
+
+    if (values.size() >= std::numeric_limits<code_type>::max())
+        throw std::length_error("RunLengthContainer dictionary is full");
+    auto code = static_cast<code_type>(values.size());
+    values.push_back(element);
+    counts.push_back(1);
+    primes.push_back(traits_type::isPrime(element) ? 1 : 0);
+    ascending.insert(ascending.begin() + static_cast<std::ptrdiff_t>(run), code);
+    if (widthFor(values.size()) > codeWidth)
+        recode({}, widthFor(values.size()));
+    pushCode(code);
+    ++elementCount;
+}
+
+// Add many elements
+template <typename T>
+void BasicRunLengthContainer<T>::addElements(std::span<const T> elements)
+{
+    codes.reserve(codes.size() + elements.size() * codeWidth);
+    for (T element : elements)
+        addElement(element);
+}
+
+// Remove the first occurrence of an element
+template <typename T>
+void BasicRunLengthContainer<T>::removeElement(T element)
+{
+    size_t run = findRun(element);
+    if (run == ascending.size() || values[ascending[run]] != element)
+        throw std::runtime_error("Element not found in container");
+
+    code_type code = ascending[run];
+    size_t pos = 0;
+    while (codeAt(pos) != code)
+        ++pos;
+    auto first = codes.begin() + static_cast<std::ptrdiff_t>(pos * codeWidth);
+    codes.erase(first, first + codeWidth);
+    --elementCount;
+
+    if (--counts[code] == 0)
+    {
+        ascending.erase(ascending.begin() + static_cast<std::ptrdiff_t>(run));
+        if (++vacant * 2 > values.size())
+            compact();
+    }
+}
+
+// The runs in ascending order
+template <typename T>
+std::vector<typename BasicRunLengthContainer<T>::Run> BasicRunLengthContainer<T>::runs() const
+{
+    std::vector<Run> result;
+    result.reserve(ascending.size());
+    for (code_type code : ascending)
+        result.push_back({values[code], counts[code]});
+    return result;
+}
+
+// Memory of the dictionary, the runs and the codes
+template <typename T>
+Footprint BasicRunLengthContainer<T>::footprint() const
+{
+    Footprint result;
+    result.used = values.size() * (sizeof(T) + sizeof(size_t) + sizeof(std::uint8_t)) +
+                  ascending.size() * sizeof(code_type) + codes.size();
+    result.capacity = values.capacity() * sizeof(T) + counts.capacity() * sizeof(size_t) + primes.capacity() +
+                      ascending.capacity() * sizeof(code_type) + codes.capacity();
+    return result;
+}
+
+// Decode into an uncompressed container
+template <typename T>
+BasicMagicalContainer<T> BasicRunLengthContainer<T>::expand(std::pmr::memory_resource *resource) const
+{
+    std::vector<T> decoded(elementCount);
+    for (size_t pos = 0; pos < elementCount; ++pos)
+        decoded[pos] = values[codeAt(pos)];
+    BasicMagicalContainer<T> result(resource);
+    result.addElements(decoded);
+    return result;
+}
+
+// BasicIterator equality comparison operator
+template <typename T>
+bool BasicRunLengthContainer<T>::BasicIterator::operator==(const BasicIterator &other) const
+{
+    if (container != other.container)
+        throw std::invalid_argument("Cant compare iterators from different containers");
+    return pos == other.pos;
+}
+
+// BasicIterator inequality comparison operator
+template <typename T>
+bool BasicRunLengthContainer<T>::BasicIterator::operator!=(const BasicIterator &other) const
+{
+    return !(*this == other);
+}
+
+// BasicIterator greater than comparison operator
+template <typename T>
+bool BasicRunLengthContainer<T>::BasicIterator::operator>(const BasicIterator &other) const
+{
+    if (container != other.container)
+        throw std::invalid_argument("Cant compare iterators from different containers");
+    return pos > other.pos;
+}
+
+// BasicIterator less than comparison operator
+template <typename T>
+bool BasicRunLengthContainer<T>::BasicIterator::operator<(const BasicIterator &other) const
+{
+    if (container != other.container)
+        throw std::invalid_argument("Cant compare iterators from different containers");
+    return pos < other.pos;
+}
+
+// Dereference operator for AscendingIterator
+template <typename T>
+T BasicRunLengthContainer<T>::AscendingIterator::operator*() const
+{
+    if (this->pos >= this->container->elementCount)
+        throw std::runtime_error("Iterator is out of range");
+    return this->container->valueAt(cursor);
+}
+
+// Pre-increment operator for AscendingIterator
+template <typename T>
+typename BasicRunLengthContainer<T>::AscendingIterator &BasicRunLengthContainer<T>::AscendingIterator::operator++()
+{
+    if (this->pos >= this->container->elementCount)
+        throw std::runtime_error("Iterator is out of range");
+    this->container->forward(cursor);
+    ++this->pos;
+    return *this;
+}
+
+// Begin function for AscendingIterator
+template <typename T>
+typename BasicRunLengthContainer<T>::AscendingIterator BasicRunLengthContainer<T>::AscendingIterator::begin() const
+{
+    return AscendingIterator(*this->container);
+}
+
+// End function for AscendingIterator
+template <typename T>
+typename BasicRunLengthContainer<T>::AscendingIterator BasicRunLengthContainer<T>::AscendingIterator::end() const
+{
+    AscendingIterator temp(*this->container);
+    temp.pos = this->container->elementCount;
+    temp.cursor.run = this->container->ascending.size();
+    return temp;
+}
+
+// SideCrossIterator constructor, the high cursor starts at the last occurrence of the largest run
+template <typename T>
+BasicRunLengthContainer<T>::SideCrossIterator::SideCrossIterator(const BasicRunLengthContainer &container)
+    : BasicIterator(container)
+{
+    if (!container.ascending.empty())
+    {
+        high.run = container.ascending.size() - 1;
+        high.offset = container.counts[container.ascending[high.run]] - 1;
+    }
+}
+
+// Dereference operator for SideCrossIterator
+template <typename T>
+T BasicRunLengthContainer<T>::SideCrossIterator::operator*() const
+{
+    if (this->pos >= this->container->elementCount)
+        throw std::runtime_error("Iterator is out of range");
+    return this->container->valueAt(this->pos % 2 == 0 ? low : high);
+}
+
+// Pre-increment operator for SideCrossIterator
+template <typename T>
+typename BasicRunLengthContainer<T>::SideCrossIterator &BasicRunLengthContainer<T>::SideCrossIterator::operator++()
+{
+    if (this->pos >= this->container->elementCount)
+        throw std::runtime_error("Iterator is out of range");
+    if (this->pos % 2 == 0)
+        this->container->forward(low);
+    else
+        this->container->backward(high);
+    ++this->pos;
+    return *this;
+}
+
+// Begin function for SideCrossIterator
+template <typename T>
+typename BasicRunLengthContainer<T>::SideCrossIterator BasicRunLengthContainer<T>::SideCrossIterator::begin() const
+{
+    return SideCrossIterator(*this->container);
+}
+
+// End function for SideCrossIterator
+template <typename T>
+typename BasicRunLengthContainer<T>::SideCrossIterator BasicRunLengthContainer<T>::SideCrossIterator::end() const
+{
+    SideCrossIterator temp(*this);
+    temp.pos = this->container->elementCount;
+    return temp;
+}
+
+// PrimeIterator constructor, positioned at the first prime
+template <typename T>
+BasicRunLengthContainer<T>::PrimeIterator::PrimeIterator(const BasicRunLengthContainer &container)
+    : BasicIterator(container)
+{
+    skipComposites();
+}
+
+// Move to the next element whose code is prime
+template <typename T>
+void BasicRunLengthContainer<T>::PrimeIterator::skipComposites()
+{
+    while (this->pos < this->container->elementCount && this->container->primes[this->container->codeAt(this->pos)] == 0)
+        ++this->pos;
+}
+
+// Dereference operator for PrimeIterator
+template <typename T>
+T BasicRunLengthContainer<T>::PrimeIterator::operator*() const
+{
+    if (this->pos >= this->container->elementCount)
+        throw std::runtime_error("Iterator is out of range");
+    return this->container->values[this->container->codeAt(this->pos)];
+}
+
+// Pre-increment operator for PrimeIterator
+template <typename T>
+typename BasicRunLengthContainer<T>::PrimeIterator &BasicRunLengthContainer<T>::PrimeIterator::operator++()
+{
+    if (this->pos >= this->container->elementCount)
+        throw std::runtime_error("Iterator is out of range");
+    ++this->pos;
+    skipComposites();
+    return *this;
+}
+
+// Begin function for PrimeIterator
+template <typename T>
+typename BasicRunLengthContainer<T>::PrimeIterator BasicRunLengthContainer<T>::PrimeIterator::begin() const
+{
+    return PrimeIterator(*this->container);
+}
+
+// End function for PrimeIterator
+template <typename T>
+typename BasicRunLengthContainer<T>::PrimeIterator BasicRunLengthContainer<T>::PrimeIterator::end() const
+{
+    PrimeIterator temp(*this);
+    temp.pos = this->container->elementCount;
+    return temp;
+}
+
+// The element types the container is compiled for
+template class ariel::BasicRunLengthContainer<int>;
+template class ariel::BasicRunLengthContainer<std::uint32_t>;
+template class ariel::BasicRunLengthContainer<std::int64_t>;
+template class ariel::BasicRunLengthContainer<std::uint64_t>;
@@ -0,0 +1,284 @@
+/**
+ * @file RunLengthContainer.hpp
+ * @brief Defines a MagicalContainer variant for elements with few distinct values.
+ * @details BasicRunLengthContainer keeps one dictionary entry per distinct value: the value,
+ * its number of occurrences and whether it is prime. The ascending view is the list of
+ * dictionary codes ordered by value, i.e. one (value, count) run per distinct value, and
+ * the insertion order is stored as dictionary codes packed in 1, 2 or 4 bytes depending on
+ * the size of the dictionary. The cross and prime orders are derived from these on the fly,
+ * so the views and their rebuilds scale with the number of distinct values; only the packed
+ * codes grow with the number of elements.
+ *
+ * @author Maya Rom
+ * @ID 207485251
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+#include "Column.hpp"
+#include "ElementTraits.hpp"
+#include "MagicalContainer.hpp"
+
+namespace ariel
+{
+    /**
+     * @class BasicRunLengthContainer
+     * @brief A run-length compressed container with the iterators of MagicalContainer.
+     * @tparam T The integer element type.
+     */
+    template <typename T>
+    class BasicRunLengthContainer
+    {
+    public:
+        using value_type = T;
+        using traits_type = ElementTraits<T>;
+        using code_type = std::uint32_t;
+
+        /**
+         * @struct Run
+         * @brief One distinct value and its number of occurrences.
+         */
+        struct Run
+        {
+            T value;
+            size_t count;
+        };
+
+    private:
+        // the dictionary, indexed by code; a code whose count is zero is vacant
+        std::pmr::vector<T> values;
+        std::pmr::vector<size_t> counts;
+        std::pmr::vector<std::uint8_t> primes;
+        std::pmr::vector<code_type> ascending; // the codes in use, ordered by value
+        size_t vacant = 0;
+
+        // the insertion order, as codes of codeWidth bytes each
+        std::pmr::vector<std::uint8_t> codes;
+        unsigned codeWidth = 1;
+        size_t elementCount = 0;
+
+        /**
+         * @brief A position in the ascending order: the run and the occurrence within it.
+         */
+        struct Cursor
+        {
+            size_t run = 0;
+            size_t offset = 0;
+        };
+
+        code_type codeAt(size_t pos) const;
+        void pushCode(code_type code);
+
+        /**
+         * @brief Rewrite the packed codes through `remap` with the given width.
+         */
+        void recode(const std::vector<code_type> &remap, unsigned width);
+
+        /**
+         * @brief Drop the vacant dictionary entries and renumber the codes.
+         */
+        void compact();
+
+        /**
+         * @brief Binary search the ascending runs for a value.
+         * @return The position of the first run whose value is not less than value.
+         */
+        size_t findRun(T value) const;
+
+        void forward(Cursor &cursor) const;
+        void backward(Cursor &cursor) const;
+        T valueAt(const Cursor &cursor) const { return values[ascending[cursor.run]]; }
+
+        /**
+         * @class BasicIterator
+         * @brief Base class for the iterator classes of RunLengthContainer.
+         */
+        class BasicIterator
+        {
+        protected:
+            const BasicRunLengthContainer *container;
+            size_t pos;
+
+        public:
+            BasicIterator(const BasicRunLengthContainer &container) : container(&container), pos(0) {}
+
+            /**
+             * @brief Equality operator for BasicIterator.
+             * @throws std::invalid_argument if the iterators belong to different containers.
+             */
+            bool operator==(const BasicIterator &other) const;
+
+            /**
+             * @brief Inequality operator for BasicIterator.
+             * @throws std::invalid_argument if the iterators belong to different containers.
+             */
+            bool operator!=(const BasicIterator &other) const;
+
+            /**
+             * @brief Greater than operator for BasicIterator.
+             * @throws std::invalid_argument if the iterators belong to different containers.
+             */
+            bool operator>(const BasicIterator &other) const;
+
+            /**
+             * @brief Less than operator for BasicIterator.
+             * @throws std::invalid_argument if the iterators belong to different containers.
+             */
+            bool operator<(const BasicIterator &other) const;
+        };
+
+    public:
+        /**
+         * @brief Constructs an empty RunLengthContainer.
+         * @param resource The memory resource to allocate from (must outlive the container).
+         */
+        explicit BasicRunLengthContainer(std::pmr::memory_resource *resource = std::pmr::get_default_resource());
+
+        /**
+         * @brief Add an element to the container, in O(log d) for an existing value and
+         * O(d) for a new one, with d the number of distinct values.
+         * @param element The element to add.
+         * @throws std::length_error if the dictionary cannot take another value.
+         */
+        void addElement(T element);
+
+        /**
+         * @brief Add many elements to the container.
+         * @param elements The elements to add, in insertion order.
+         */
+        void addElements(std::span<const T> elements);
+
+        /**
+         * @brief Remove the first inserted occurrence of an element from the container.
+         * @param element The element to remove.
+         * @throws std::runtime_error if the element is not in the container.
+         */
+        void removeElement(T element);
+
+        /**
+         * @brief Get the number of elements, counting every occurrence.
+         */
+        size_t size() const { return elementCount; }
+
+        /**
+         * @brief Get the number of distinct values.
+         */
+        size_t distinct() const { return ascending.size(); }
+
+        /**
+         * @brief Get the (value, count) runs in ascending order of value.
+         */
+        std::vector<Run> runs() const;
+
+        /**
+         * @brief Get the bytes used and allocated by the dictionary, the runs and the packed codes.
+         */
+        Footprint footprint() const;
+
+        /**
+         * @brief Get an uncompressed MagicalContainer with the same elements in the same insertion order.
+         * @param resource The memory resource of the new container.
+         */
+        BasicMagicalContainer<T> expand(std::pmr::memory_resource *resource = std::pmr::get_default_resource()) const;
+
+        /**
+         * @class AscendingIterator
+         * @brief Every occurrence of every element in ascending order, walking the runs.
+         * @note Like all the iterators of this container it is invalidated by add and remove.
+         */
+        class AscendingIterator : public BasicIterator
+        {
+            Cursor cursor;
+
+        public:
+            AscendingIterator(const BasicRunLengthContainer &container) : BasicIterator(container) {}
+
+            /**
+             * @brief Dereference operator for AscendingIterator.
+             * @throws std::runtime_error if the iterator is at the end.
+             */
+            T operator*() const;
+
+            /**
+             * @brief Pre-increment operator for AscendingIterator.
+             * @throws std::runtime_error if the iterator is at the end.
+             */
+            AscendingIterator &operator++();
+
+            AscendingIterator begin() const;
+            AscendingIterator end() const;
+        };
+
+        /**
+         * @class SideCrossIterator
+         * @brief The elements alternating from the smallest and the largest end of the runs.
+         */
+        class SideCrossIterator : public BasicIterator
+        {
+            Cursor low;
+            Cursor high;
+
+        public:
+            SideCrossIterator(const BasicRunLengthContainer &container);
+
+            /**
+             * @brief Dereference operator for SideCrossIterator.
+             * @throws std::runtime_error if the iterator is at the end.
+             */
+            T operator*() const;
+
+            /**
+             * @brief Pre-increment operator for SideCrossIterator.
+             * @throws std::runtime_error if the iterator is at the end.
+             */
+            SideCrossIterator &operator++();
+
+            SideCrossIterator begin() const;
+            SideCrossIterator end() const;
+        };
+
+        /**
+         * @class PrimeIterator
+         * @brief The prime elements in insertion order, skipping the codes of composite values.
+         */
+        class PrimeIterator : public BasicIterator
+        {
+            void skipComposites();
+
+        public:
+            PrimeIterator(const BasicRunLengthContainer &container);
+
+            /**
+             * @brief Dereference operator for PrimeIterator.
+             * @throws std::runtime_error if the iterator is at the end.
+             */
+            T operator*() const;
+
+            /**
+             * @brief Pre-increment operator for PrimeIterator.
+             * @throws std::runtime_error if the iterator is at the end.
+             */
+            PrimeIterator &operator++();
+
+            PrimeIterator begin() const;
+            PrimeIterator end() const;
+        };
+    };
+
+    extern template class BasicRunLengthContainer<int>;
+    extern template class BasicRunLengthContainer<std::uint32_t>;
+    extern template class BasicRunLengthContainer<std::int64_t>;
+    extern template class BasicRunLengthContainer<std::uint64_t>;
+
+    /**
+     * @brief The run-length compressed container of `int` elements.
+     */
+    using RunLengthContainer = BasicRunLengthContainer<int>;
+}
@@ -0,0 +1,131 @@
+#include "ThreadPool.hpp"
+#include <exception>
+#include <latch>
+
+using namespace ariel;
+using namespace std;
+
+// Start the workers
+ThreadPool::ThreadPool(size_t threads)
+{
+    if (threads == 0)
+    {
+        unsigned hardware = std::thread::hardware_concurrency();
+        threads = hardware > 1 ? hardware - 1 : 1;
+    }
+    for (size_t i = 0; i < threads; ++i)
+        queues.push_back(std::make_unique<Queue>());
+    workers.reserve(threads);
+    for (size_t i = 0; i < threads; ++i)
+        workers.emplace_back([this, i]
+                             { work(i); });
+}
+
+// Stop and join the workers
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto &worker : workers)
+        worker.join();
+}
+
+// Pop from the own deque, or steal from the front of another one
+bool ThreadPool::runOne(size_t self)
+{
+    std::function<void()> task;
+    if (self < queues.size())
+    {
+        std::lock_guard<std::mutex> lock(queues[self]->mutex);
+        if (!queues[self]->tasks.empty())
+        {
+            task = std::move(queues[self]->tasks.back());
+            queues[self]->tasks.pop_back();
+        }
+    }
+    for (size_t i = 1; !task && i <= queues.size(); ++i)
+    {
+        Queue &victim = *queues[(self + i) % queues.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty())
+        {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+        }
+    }
+    if (!task)
+        return false;
+    queued.fetch_sub(1);
+    task();
+    return true;
+}
+
+// Worker loop, sleeps while every deque is empty
+void ThreadPool::work(size_t self)
+{
+    while (true)
+    {
+        if (runOne(self))
+            continue;
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        wake.wait(lock, [this]
+                  { return stopping || queued.load() > 0; });
+        if (stopping && queued.load() == 0)
+            return;
+    }
+}
+
+// Spread a batch over the deques and help until it is done
+void ThreadPool::run(std::vector<std::function<void()>> tasks)
+{
+    if (tasks.empty())
+        return;
+
+    std::latch done(static_cast<std::ptrdiff_t>(tasks.size()));
+    std::mutex failureMutex;
+    std::exception_ptr failure;
+    size_t start = next.fetch_add(1);
+    for (size_t i = 0; i < tasks.size(); ++i)
+    {
+        Queue &queue = *queues[(start + i) % queues.size()];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.tasks.push_back([&, task = std::move(tasks[i])]
+                              {
+                                  try
+                                  {
+                                      task();
+                                  }
+                                  catch (...)
+                                  {
+                                      std::lock_guard<std::mutex> failureLock(failureMutex);
+                                      if (!failure)
+                                          failure = std::current_exception();
+                                  }
+                                  done.count_down(); });
+        queued.fetch_add(1);
+    }
+    {
+        // taking the lock orders the wake-up after a worker that is about to wait
+        std::lock_guard<std::mutex> lock(sleepMutex);
+    }
+    wake.notify_all();
+
+    // help while there are queued tasks; once none is left, every task of the batch has
+    // been taken, so block until the last one finishes instead of spinning
+    while (!done.try_wait() && runOne(queues.size()))
+    {
+    }
+    done.wait();
+    if (failure)
+        std::rethrow_exception(failure);
+}
+
+// The pool of the parallel helpers
+ThreadPool &ThreadPool::shared()
+{
+    static ThreadPool pool;
+    return pool;
+}
@@ -0,0 +1,89 @@
+/**
+ * @file ThreadPool.hpp
+ * @brief A small work-stealing thread pool for the parallel helpers of MagicalContainer.
+ * @details Every worker owns a task deque. A batch of tasks is spread over the deques;
+ * a worker takes tasks from the back of its own deque and, once it is empty, steals from
+ * the front of the others. The thread that submits a batch runs tasks too until the whole
+ * batch is done, so a pool of n workers keeps n + 1 threads busy.
+ *
+ * @author Maya Rom
+ * @ID 207485251
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ariel
+{
+    /**
+     * @class ThreadPool
+     * @brief Fixed worker threads running batches of tasks with work stealing.
+     */
+    class ThreadPool
+    {
+        struct Queue
+        {
+            std::mutex mutex;
+            std::deque<std::function<void()>> tasks;
+        };
+
+        std::vector<std::unique_ptr<Queue>> queues;
+        std::vector<std::thread> workers;
+        std::atomic<size_t> queued{0}; // tasks waiting in any deque
+        std::atomic<size_t> next{0};   // round-robin start for the next batch
+        std::mutex sleepMutex;
+        std::condition_variable wake;
+        bool stopping = false;
+
+        /**
+         * @brief Run one task, preferring the deque of `self` and stealing otherwise.
+         * @param self The deque of the calling worker, or queues.size() for a submitting thread.
+         * @return false if every deque was empty.
+         */
+        bool runOne(size_t self);
+
+        void work(size_t self);
+
+    public:
+        /**
+         * @brief Start the worker threads.
+         * @param threads The number of workers; 0 means one per hardware thread, minus the caller.
+         */
+        explicit ThreadPool(size_t threads = 0);
+
+        /**
+         * @brief Finish the queued tasks and join the workers.
+         */
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool &) = delete;
+        ThreadPool &operator=(const ThreadPool &) = delete;
+
+        /**
+         * @brief Get the number of threads that run a batch, the workers and the caller.
+         */
+        size_t concurrency() const { return workers.size() + 1; }
+
+        /**
+         * @brief Run a batch of tasks and wait until all of them have finished.
+         * @details The calling thread runs tasks while it waits. If tasks throw, the
+         * first exception is rethrown once the whole batch is done.
+         * @param tasks The tasks of the batch.
+         */
+        void run(std::vector<std::function<void()>> tasks);
+
+        /**
+         * @brief The pool shared by the parallel helpers, started on first use.
+         */
+        static ThreadPool &shared();
+    };
+}
@@ -0,0 +1,554 @@
+/**
+ * @file Views.hpp
+ * @brief Generic, incrementally maintained views over the elements of a MagicalContainer.
+ * @details A view is a vector of element indices. FilterView keeps the indices of the
+ * elements accepted by a predicate in insertion order, OrderView keeps all indices ordered
+ * by a comparator. Both are updated in place when an element is added or removed, so a
+ * mutation never has to rebuild them from scratch. The built-in ascending and prime views
+ * are instances of these templates; user-defined predicates and comparators get the
+ * same maintenance by registering a view type with BasicMagicalContainer::view().
+ *
+ * @author Maya Rom
+ * @ID 207485251
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <memory_resource>
+#include <numeric>
+#include <type_traits>
+#include <vector>
+
+#include "Column.hpp"
+#include "ElementTraits.hpp"
+
+namespace ariel
+{
+    /**
+     * @brief Predicate accepting the prime elements.
+     */
+    struct IsPrime
+    {
+        template <typename T>
+        bool operator()(T value) const { return ElementTraits<T>::isPrime(value); }
+    };
+
+    /**
+     * @brief Predicate accepting the even elements.
+     */
+    struct IsEven
+    {
+        template <typename T>
+        bool operator()(T value) const { return value % 2 == 0; }
+    };
+
+    /**
+     * @brief Predicate accepting the odd elements.
+     */
+    struct IsOdd
+    {
+        template <typename T>
+        bool operator()(T value) const { return value % 2 != 0; }
+    };
+
+    /**
+     * @brief Predicate accepting the elements in the band [Low, High].
+     */
+    template <auto Low, auto High>
+    struct InBand
+    {
+        template <typename T>
+        bool operator()(T value) const { return Low <= value && value <= High; }
+    };
+
+    /**
+     * @class FilterView
+     * @brief The indices of the elements accepted by Predicate, in insertion order.
+     */
+    template <typename T, typename Index, typename Predicate>
+    class FilterView
+    {
+        Column<Index> indices;
+        Predicate predicate;
+
+    public:
+        explicit FilterView(std::pmr::memory_resource *resource = std::pmr::get_default_resource())
+            : indices(resource) {}
+
+        FilterView(const FilterView &other, std::pmr::memory_resource *resource)
+            : indices(other.indices, resource), predicate(other.predicate) {}
+
+        size_t size() const { return indices.size(); }
+        Index operator[](size_t pos) const { return indices[pos]; }
+        const Column<Index> &data() const { return indices; }
+        void reserve(size_t capacity) { indices.own().reserve(capacity); }
+
+        /**
+         * @brief Read the view from a prebuilt index array that outlives it.
+         */
+        void borrow(const Index *source, size_t count) { indices.borrow(source, count); }
+
+        /**
+         * @brief Bytes of the index array.
+         */
+        Footprint footprint() const { return indices.footprint(); }
+
+        /**
+         * @brief Rebuild the view from all the elements.
+         */
+        void rebuild(const T *values, size_t count)
+        {
+            auto &out = indices.fresh();
+            for (size_t i = 0; i < count; ++i)
+            {
+                if (predicate(values[i]))
+                    out.push_back(static_cast<Index>(i));
+            }
+        }
+
+        /**
+         * @brief Account for the elements of another container's view appended after
+         * the first `offset` elements, without testing them again.
+         */
+        void append(const FilterView &other, size_t offset)
+        {
+            auto &own = indices.own();
+            own.reserve(own.size() + other.size());
+            for (Index index : other.indices)
+                own.push_back(static_cast<Index>(index + offset));
+        }
+
+        /**
+         * @brief Account for the element appended at values[count - 1].
+         */
+        void inserted(const T *values, size_t count)
+        {
+            if (predicate(values[count - 1]))
+                indices.own().push_back(static_cast<Index>(count - 1));
+        }
+
+        /**
+         * @brief Account for the element at `index` being removed. Called before the
+         * element is erased from the storage.
+         */
+        void erased(const T * /*values*/, size_t index)
+        {
+            auto &own = indices.own();
+            auto it = std::lower_bound(own.begin(), own.end(), static_cast<Index>(index));
+            if (it != own.end() && *it == index)
+                it = own.erase(it);
+            // the indices are in insertion order, so only the tail shifts down
+            for (; it != own.end(); ++it)
+                --*it;
+        }
+    };
+
+    /**
+     * @class OrderView
+     * @brief All element indices, stably ordered by Compare on the element values.
+     * @details Equal elements keep their insertion order, so an index is found by
+     * binary search on (value, index). std::less and std::greater views are
+     * rebuilt with the radix kernel of the element type.
+     */
+    template <typename T, typename Index, typename Compare>
+    class OrderView
+    {
+        static constexpr bool ascending = std::is_same_v<Compare, std::less<T>> || std::is_same_v<Compare, std::less<>>;
+        static constexpr bool descending = std::is_same_v<Compare, std::greater<T>> || std::is_same_v<Compare, std::greater<>>;
+
+        Column<Index> indices;
+        Compare compare;
+        RadixScratch<T, Index> scratch; // reusable buffers for radix rebuilds
+
+        // orders indices of elements by (value, index)
+        bool before(const T *values, Index a, Index b) const
+        {
+            if (compare(values[a], values[b]))
+                return true;
+            if (compare(values[b], values[a]))
+                return false;
+            return a < b;
+        }
+
+    public:
+        explicit OrderView(std::pmr::memory_resource *resource = std::pmr::get_default_resource())
+            : indices(resource), scratch(resource) {}
+
+        OrderView(const OrderView &other, std::pmr::memory_resource *resource)
+            : indices(other.indices, resource), compare(other.compare), scratch(resource) {}
+
+        size_t size() const { return indices.size(); }
+        Index operator[](size_t pos) const { return indices[pos]; }
+        const Column<Index> &data() const { return indices; }
+        void reserve(size_t capacity) { indices.own().reserve(capacity); }
+
+        /**
+         * @brief Read the view from a prebuilt index array that outlives it.
+         */
+        void borrow(const Index *source, size_t count) { indices.borrow(source, count); }
+
+        /**
+         * @brief Bytes of the index array.
+         */
+        Footprint footprint() const { return indices.footprint(); }
+
+        /**
+         * @brief Bytes kept between rebuilds by the radix sorting buffers.
+         */
+        size_t scratchBytes() const { return scratch.capacityBytes(); }
+
+        /**
+         * @brief Rebuild the view from all the elements.
+         */
+        void rebuild(const T *values, size_t count)
+        {
+            auto &out = indices.fresh();
+            if constexpr (ascending)
+            {
+                scratch.sortIndices(values, count, out);
+            }
+            else if constexpr (descending)
+            {
+                // equal runs come out of the ascending pass in index order; reversing the
+                // whole permutation flips them, so restore index order within each run
+                scratch.sortIndices(values, count, out);
+                std::reverse(out.begin(), out.end());
+                for (auto run = out.begin(); run != out.end();)
+                {
+                    auto last = std::find_if(run, out.end(), [&](Index i)
+                                             { return values[i] != values[*run]; });
+                    std::reverse(run, last);
+                    run = last;
+                }
+            }
+            else
+            {
+                out.resize(count);
+                for (size_t i = 0; i < count; ++i)
+                    out[i] = static_cast<Index>(i);
+                std::stable_sort(out.begin(), out.end(), [&](Index a, Index b)
+                                 { return compare(values[a], values[b]); });
+            }
+        }
+
+        /**
+         * @brief Rebuild the view of elements that are already stored in view order.
+         */
+        void rebuildOrdered(size_t count)
+        {
+            auto &out = indices.fresh();
+            out.resize(count);
+            std::iota(out.begin(), out.end(), Index(0));
+        }
+
+        /**
+         * @brief Merge in O(n) the view of another container whose elements were appended
+         * after the first `offset` elements. Ties keep the elements of this view first.
+         */
+        void merge(const T *values, const OrderView &other, size_t offset)
+        {
+            auto &own = indices.own();
+            size_t mine = own.size();
+            size_t theirs = other.size();
+            own.resize(mine + theirs);
+            // merge from the back so the result is written in place
+            for (size_t out = mine + theirs; theirs > 0;)
+            {
+                auto next = static_cast<Index>(other.indices[theirs - 1] + offset);
+                if (mine > 0 && compare(values[next], values[own[mine - 1]]))
+                    own[--out] = own[--mine];
+                else
+                {
+                    own[--out] = next;
+                    --theirs;
+                }
+            }
+        }
+
+        /**
+         * @brief Account for the element appended at values[count - 1].
+         */
+        void inserted(const T *values, size_t count)
+        {
+            const T &value = values[count - 1];
+            auto &own = indices.own();
+            auto it = std::upper_bound(own.begin(), own.end(), value, [&](const T &v, Index i)
+                                       { return compare(v, values[i]); });
+            own.insert(it, static_cast<Index>(count - 1));
+        }
+
+        /**
+         * @brief Account for the element at `index` being removed. Called before the
+         * element is erased from the storage.
+         */
+        void erased(const T *values, size_t index)
+        {
+            auto &own = indices.own();
+            auto it = std::lower_bound(own.begin(), own.end(), static_cast<Index>(index), [&](Index a, Index b)
+                                       { return before(values, a, b); });
+            if (it != own.end() && *it == index)
+                own.erase(it);
+            for (Index &i : own)
+            {
+                if (i > index)
+                    --i;
+            }
+        }
+    };
+
+    /**
+     * @class FenwickIndex
+     * @brief Counts and sums of the elements over value ranges, in O(log D) for D distinct values.
+     * @details Two Fenwick trees over the sorted distinct values hold the number of elements
+     * and their sum per value. Adding or removing a value already present is O(log D); a new
+     * value is inserted into the coordinates and the trees are rebuilt in O(D). Values whose
+     * count drops to zero keep their coordinate until more than half the coordinates are
+     * vacant, then the index is compacted.
+     */
+    template <typename T, typename Index>
+    class FenwickIndex
+    {
+    public:
+        using sum_type = typename ElementTraits<T>::sum_type;
+
+    private:
+        // the trees add in unsigned arithmetic, so sums past the range of sum_type wrap
+        // instead of overflowing; sumInRange converts back modulo 2^64
+        using tree_sum_type = std::make_unsigned_t<sum_type>;
+
+        std::pmr::vector<T> coordinates;      // sorted distinct values
+        std::pmr::vector<Index> counts;       // Fenwick tree of the number of elements per coordinate
+        std::pmr::vector<tree_sum_type> sums; // Fenwick tree of the sum of the elements per coordinate
+        size_t vacant = 0;               // coordinates whose count is zero
+
+        template <typename U>
+        static void build(std::pmr::vector<U> &tree)
+        {
+            for (size_t i = 0; i < tree.size(); ++i)
+            {
+                size_t parent = i | (i + 1);
+                if (parent < tree.size())
+                    tree[parent] = static_cast<U>(tree[parent] + tree[i]);
+            }
+        }
+
+        // inverse of build: turn the tree back into the plain per-coordinate array
+        template <typename U>
+        static void flatten(std::pmr::vector<U> &tree)
+        {
+            for (size_t i = tree.size(); i-- > 0;)
+            {
+                size_t parent = i | (i + 1);
+                if (parent < tree.size())
+                    tree[parent] = static_cast<U>(tree[parent] - tree[i]);
+            }
+        }
+
+        template <typename U>
+        static U prefix(const std::pmr::vector<U> &tree, size_t end)
+        {
+            U total = 0;
+            for (; end > 0; end &= end - 1)
+                total = static_cast<U>(total + tree[end - 1]);
+            return total;
+        }
+
+        void add(size_t pos, bool insert, T value)
+        {
+            for (; pos < counts.size(); pos |= pos + 1)
+            {
+                counts[pos] = static_cast<Index>(insert ? counts[pos] + 1 : counts[pos] - 1);
+                sums[pos] = static_cast<tree_sum_type>(insert ? sums[pos] + static_cast<tree_sum_type>(value)
+                                                              : sums[pos] - static_cast<tree_sum_type>(value));
+            }
+        }
+
+        size_t countAt(size_t pos) const
+        {
+            return prefix(counts, pos + 1) - prefix(counts, pos);
+        }
+
+        // drop the vacant coordinates
+        void compact()
+        {
+            flatten(counts);
+            flatten(sums);
+            size_t kept = 0;
+            for (size_t i = 0; i < coordinates.size(); ++i)
+            {
+                if (counts[i] == 0)
+                    continue;
+                coordinates[kept] = coordinates[i];
+                counts[kept] = counts[i];
+                sums[kept] = sums[i];
+                ++kept;
+            }
+            coordinates.resize(kept);
+            counts.resize(kept);
+            sums.resize(kept);
+            vacant = 0;
+            build(counts);
+            build(sums);
+        }
+
+        size_t lowerPos(T value) const
+        {
+            return static_cast<size_t>(std::lower_bound(coordinates.begin(), coordinates.end(), value) - coordinates.begin());
+        }
+
+        size_t upperPos(T value) const
+        {
+            return static_cast<size_t>(std::upper_bound(coordinates.begin(), coordinates.end(), value) - coordinates.begin());
+        }
+
+    public:
+        explicit FenwickIndex(std::pmr::memory_resource *resource = std::pmr::get_default_resource())
+            : coordinates(resource), counts(resource), sums(resource) {}
+
+        FenwickIndex(const FenwickIndex &other, std::pmr::memory_resource *resource)
+            : coordinates(other.coordinates, resource), counts(other.counts, resource),
+              sums(other.sums, resource), vacant(other.vacant) {}
+
+        /**
+         * @brief Get the number of elements in [low, high].
+         */
+        size_t countInRange(T low, T high) const
+        {
+            if (high < low)
+                return 0;
+            return prefix(counts, upperPos(high)) - prefix(counts, lowerPos(low));
+        }
+
+        /**
+         * @brief Get the sum of the elements in [low, high].
+         */
+        sum_type sumInRange(T low, T high) const
+        {
+            if (high < low)
+                return 0;
+            return static_cast<sum_type>(prefix(sums, upperPos(high)) - prefix(sums, lowerPos(low)));
+        }
+
+        /**
+         * @brief Bytes of the coordinates and of both trees.
+         */
+        Footprint footprint() const
+        {
+            return {coordinates.size() * sizeof(T) + counts.size() * sizeof(Index) + sums.size() * sizeof(tree_sum_type),
+                    coordinates.capacity() * sizeof(T) + counts.capacity() * sizeof(Index) + sums.capacity() * sizeof(tree_sum_type)};
+        }
+
+        /**
+         * @brief Rebuild the index from all the elements.
+         */
+        void rebuild(const T *values, size_t count)
+        {
+            coordinates.assign(values, values + count);
+            std::sort(coordinates.begin(), coordinates.end());
+            coordinates.erase(std::unique(coordinates.begin(), coordinates.end()), coordinates.end());
+            counts.assign(coordinates.size(), 0);
+            sums.assign(coordinates.size(), 0);
+            for (size_t i = 0; i < count; ++i)
+            {
+                size_t pos = lowerPos(values[i]);
+                ++counts[pos];
+                sums[pos] = static_cast<tree_sum_type>(sums[pos] + static_cast<tree_sum_type>(values[i]));
+            }
+            vacant = 0;
+            build(counts);
+            build(sums);
+        }
+
+        /**
+         * @brief Account for the element appended at values[count - 1].
+         */
+        void inserted(const T *values, size_t count)
+        {
+            T value = values[count - 1];
+            size_t pos = lowerPos(value);
+            if (pos == coordinates.size() || coordinates[pos] != value)
+            {
+                flatten(counts);
+                flatten(sums);
+                coordinates.insert(coordinates.begin() + static_cast<std::ptrdiff_t>(pos), value);
+                counts.insert(counts.begin() + static_cast<std::ptrdiff_t>(pos), 1);
+                sums.insert(sums.begin() + static_cast<std::ptrdiff_t>(pos), static_cast<tree_sum_type>(value));
+                build(counts);
+                build(sums);
+                return;
+            }
+            if (countAt(pos) == 0)
+                --vacant;
+            add(pos, true, value);
+        }
+
+        /**
+         * @brief Account for the element at `index` being removed. Called before the
+         * element is erased from the storage.
+         */
+        void erased(const T *values, size_t index)
+        {
+            T value = values[index];
+            size_t pos = lowerPos(value);
+            add(pos, false, value);
+            if (countAt(pos) == 0 && ++vacant * 2 > coordinates.size())
+                compact();
+        }
+    };
+
+    /**
+     * @class AnyView
+     * @brief Type-erased handle to a view registered with a container.
+     */
+    template <typename T>
+    class AnyView
+    {
+    public:
+        virtual ~AnyView() = default;
+        virtual const void *key() const = 0;
+        virtual void rebuild(const T *values, size_t count) = 0;
+        virtual void inserted(const T *values, size_t count) = 0;
+        virtual void erased(const T *values, size_t index) = 0;
+        virtual Footprint footprint() const = 0;
+        virtual std::unique_ptr<AnyView> clone(std::pmr::memory_resource *resource) const = 0;
+
+        /**
+         * @brief A process-wide unique key for a view type.
+         */
+        template <typename View>
+        static const void *keyOf()
+        {
+            static const char key = 0;
+            return &key;
+        }
+    };
+
+    /**
+     * @class ViewHolder
+     * @brief Owns a concrete view and forwards the maintenance calls to it.
+     */
+    template <typename T, typename View>
+    class ViewHolder final : public AnyView<T>
+    {
+    public:
+        View view;
+
+        explicit ViewHolder(std::pmr::memory_resource *resource) : view(resource) {}
+        ViewHolder(const View &other, std::pmr::memory_resource *resource) : view(other, resource) {}
+
+        const void *key() const override { return AnyView<T>::template keyOf<View>(); }
+        void rebuild(const T *values, size_t count) override { view.rebuild(values, count); }
+        void inserted(const T *values, size_t count) override { view.inserted(values, count); }
+        void erased(const T *values, size_t index) override { view.erased(values, index); }
+        Footprint footprint() const override { return view.footprint(); }
+
+        std::unique_ptr<AnyView<T>> clone(std::pmr::memory_resource *resource) const override
+        {
+            return std::make_unique<ViewHolder>(view, resource);
+        }
+    };
+}